@@ -0,0 +1,1796 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <Tle.h>
+#include <SGP4.h>
+#include <SatelliteBatch.h>
+#include <KeplerSolver.h>
+#include <ChebyshevEphemeris.h>
+#include <TrajectoryCache.h>
+#include <EphemerisWriter.h>
+#include <EphemerisReader.h>
+#include <PropagationCache.h>
+#include <TleCatalog.h>
+#include <SatelliteCatalog.h>
+#include <CatalogStore.h>
+#include <ModelSnapshot.h>
+#include <TlePipeline.h>
+#include <OmmCatalog.h>
+#include <TleArchive.h>
+#include <Observer.h>
+#include <TimeContext.h>
+#include <TimeGrid.h>
+#include <CoordTopocentric.h>
+#include <OrbitalElements.h>
+#include <DateTime.h>
+#include <Globals.h>
+#include <Util.h>
+
+#include <string>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+/*
+ * number of times each benchmark is repeated
+ */
+static const int kRepeat = 20;
+
+/*
+ * an element set and the times runtest propagates it to
+ */
+struct TestCase
+{
+    TestCase(const Tle& t, const double s, const double e, const double i)
+        : tle(t), start(s), end(e), inc(i)
+    {
+    }
+
+    Tle tle;
+    double start;
+    double end;
+    double inc;
+};
+
+/*
+ * read the test cases from a verification style tle file
+ */
+std::vector<TestCase> LoadTestCases(const char* infile)
+{
+    std::vector<TestCase> cases;
+    std::ifstream file(infile);
+
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening file" << std::endl;
+        return cases;
+    }
+
+    std::string line1;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        Util::Trim(line);
+
+        if (line.length() < Tle::LineLength() || line[0] == '#')
+        {
+            line1.clear();
+        }
+        else if (line[0] == '1')
+        {
+            line1 = line.substr(0, Tle::LineLength());
+        }
+        else if (line[0] == '2' && !line1.empty())
+        {
+            double start = 0.0;
+            double end = 1440.0;
+            double inc = 120.0;
+            std::istringstream parameters(line.substr(Tle::LineLength()));
+            double s;
+            double e;
+            double i;
+
+            if (parameters >> s >> e >> i)
+            {
+                start = s;
+                end = e;
+                inc = i;
+            }
+
+            try
+            {
+                cases.push_back(TestCase(Tle("Test",
+                                line1,
+                                line.substr(0, Tle::LineLength())),
+                            start, end, inc));
+            }
+            catch (TleException& e)
+            {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+            line1.clear();
+        }
+    }
+
+    return cases;
+}
+
+/*
+ * @returns seconds since start
+ */
+double Elapsed(const DateTime& start)
+{
+    return (DateTime::Now(true) - start).TotalSeconds();
+}
+
+/*
+ * print the total time and the time per unit of work, where count units
+ * took seconds
+ */
+void Report(
+        const std::string& name,
+        const double seconds,
+        const size_t count,
+        const std::string& unit = "position")
+{
+    std::cout << std::setw(40) << std::left << name << std::right
+        << std::setprecision(3) << std::fixed
+        << std::setw(10) << seconds * 1.0e3 << " ms "
+        << std::setw(10) << seconds * 1.0e9 / static_cast<double>(count)
+        << " ns/" << unit << std::endl;
+}
+
+/*
+ * a line with its checksum corrected, as the verification file has some
+ * which are wrong
+ */
+std::string WithChecksum(const std::string& line)
+{
+    unsigned int sum = 0;
+    for (size_t i = 0; i + 1 < line.length(); i++)
+    {
+        if (line[i] >= '0' && line[i] <= '9')
+        {
+            sum += static_cast<unsigned int>(line[i] - '0');
+        }
+        else if (line[i] == '-')
+        {
+            sum++;
+        }
+    }
+    return line.substr(0, line.length() - 1)
+        + static_cast<char>('0' + sum % 10);
+}
+
+/*
+ * compare propagating with and without velocity, for a day of one minute
+ * steps per satellite
+ */
+void BenchmarkPositionOnly(const std::vector<Tle>& tles)
+{
+    const size_t n = 1440;
+    std::vector<double> tsince(n);
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    std::vector<double> z(n);
+    std::vector<double> vx(n);
+    std::vector<double> vy(n);
+    std::vector<double> vz(n);
+    std::vector<SGP4::Status> status(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        tsince[i] = static_cast<double>(i);
+    }
+
+    std::vector<SGP4> models;
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        models.push_back(SGP4(tles[i]));
+    }
+
+    const size_t count = kRepeat * n * models.size();
+
+    DateTime start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            models[i].FindPositions(&tsince[0], n,
+                    &x[0], &y[0], &z[0], &vx[0], &vy[0], &vz[0], &status[0]);
+        }
+    }
+    const double full = Elapsed(start);
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            models[i].FindPositions(&tsince[0], n,
+                    &x[0], &y[0], &z[0], NULL, NULL, NULL, &status[0]);
+        }
+    }
+    const double position = Elapsed(start);
+
+    Report("SGP4 position and velocity", full, count);
+    Report("SGP4 position only", position, count);
+}
+
+/*
+ * worst difference between single and double precision over a series of
+ * times, only counting times where both succeed
+ */
+struct PrecisionError
+{
+    PrecisionError()
+        : position(0.0), velocity(0.0), count(0)
+    {
+    }
+
+    /*
+     * @returns whether the double precision propagation succeeded
+     */
+    bool Add(const SatelliteBatch& batch, const DateTime& dt)
+    {
+        double x;
+        double y;
+        double z;
+        double vx;
+        double vy;
+        double vz;
+        SGP4::Status status;
+        float fx;
+        float fy;
+        float fz;
+        float fvx;
+        float fvy;
+        float fvz;
+        SGP4::Status fstatus;
+
+        batch.FindPositions(dt, &x, &y, &z, &vx, &vy, &vz, &status);
+        batch.FindPositions(dt, &fx, &fy, &fz, &fvx, &fvy, &fvz, &fstatus);
+
+        if (status == SGP4::STATUS_OK && fstatus == SGP4::STATUS_OK)
+        {
+            const double dr = sqrt((fx - x) * (fx - x)
+                    + (fy - y) * (fy - y)
+                    + (fz - z) * (fz - z));
+            const double dv = sqrt((fvx - vx) * (fvx - vx)
+                    + (fvy - vy) * (fvy - vy)
+                    + (fvz - vz) * (fvz - vz));
+            position = dr > position ? dr : position;
+            velocity = dv > velocity ? dv : velocity;
+            count++;
+        }
+
+        return status == SGP4::STATUS_OK;
+    }
+
+    void Report(const std::string& name) const
+    {
+        std::cout << std::setw(40) << std::left << name << std::right
+            << std::setprecision(6) << std::fixed
+            << std::setw(12) << position << " km "
+            << std::setw(12) << velocity * 1.0e3 << " m/s "
+            << std::setw(8) << count << " positions" << std::endl;
+    }
+
+    double position;
+    double velocity;
+    size_t count;
+};
+
+/*
+ * report the worst error of single precision propagation against double
+ * precision for the near earth runtest cases and for longer spans
+ */
+void BenchmarkSinglePrecision(const std::vector<TestCase>& cases)
+{
+    PrecisionError verification;
+    PrecisionError day;
+    PrecisionError week;
+
+    for (size_t i = 0; i < cases.size(); i++)
+    {
+        const TestCase& test = cases[i];
+        const SatelliteBatch batch(std::vector<Tle>(1, test.tle));
+        const DateTime epoch = test.tle.Epoch();
+
+        /*
+         * deep space satellites are always propagated in double precision
+         */
+        if (OrbitalElements(test.tle).Period() >= 225.0)
+        {
+            continue;
+        }
+
+        for (double t = test.start; t <= test.end; t += test.inc)
+        {
+            verification.Add(batch, epoch.AddMinutes(t));
+        }
+
+        /*
+         * the model is meaningless after the first failure, as for a
+         * satellite which has decayed
+         */
+        for (double t = 0.0; t <= kMINUTES_PER_DAY; t += 1.0)
+        {
+            if (!day.Add(batch, epoch.AddMinutes(t)))
+            {
+                break;
+            }
+        }
+
+        for (double t = 0.0; t <= 7.0 * kMINUTES_PER_DAY; t += 10.0)
+        {
+            if (!week.Add(batch, epoch.AddMinutes(t)))
+            {
+                break;
+            }
+        }
+    }
+
+    verification.Report("single precision runtest cases");
+    day.Report("single precision 1 day");
+    week.Report("single precision 7 days");
+}
+
+/*
+ * a catalog of near earth satellites sharing an epoch, made from the near
+ * earth test cases spread around their orbits
+ */
+std::vector<Tle> NearEarthCatalog(
+        const std::vector<Tle>& tles,
+        const size_t objects)
+{
+    std::vector<Tle> near;
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        if (OrbitalElements(tles[i]).Period() < 225.0)
+        {
+            near.push_back(tles[i]);
+        }
+    }
+
+    std::vector<Tle> catalog;
+    for (size_t i = 0; i < objects; i++)
+    {
+        const Tle& tle = near[i % near.size()];
+        std::ostringstream anomaly;
+        anomaly << std::fixed << std::setprecision(4) << std::setw(8)
+            << static_cast<double>(i * 37 % 3600) / 10.0;
+
+        std::string line1 = tle.Line1();
+        std::string line2 = tle.Line2();
+        line1.replace(18, 14, "13152.50000000");
+        line2.replace(43, 8, anomaly.str());
+        catalog.push_back(Tle(WithChecksum(line1), WithChecksum(line2)));
+    }
+
+    return catalog;
+}
+
+/*
+ * a near earth catalog each hour of a day, propagating each satellite with
+ * SGP4 and the whole catalog with SatelliteBatch in double and single
+ * precision. the lane loops only vectorise in a fast math build, see the
+ * --enable-fast-math and --enable-avx2 configure options
+ */
+void BenchmarkBatch(const std::vector<Tle>& tles)
+{
+    const std::vector<Tle> catalog = NearEarthCatalog(tles, 30000);
+    const size_t size = catalog.size();
+    const size_t n = 24;
+    const size_t count = n * size;
+    const DateTime epoch = catalog[0].Epoch();
+    std::vector<SGP4> models;
+    std::vector<double> x(size);
+    std::vector<double> y(size);
+    std::vector<double> z(size);
+    std::vector<double> vx(size);
+    std::vector<double> vy(size);
+    std::vector<double> vz(size);
+    std::vector<float> fx(size);
+    std::vector<float> fy(size);
+    std::vector<float> fz(size);
+    std::vector<float> fvx(size);
+    std::vector<float> fvy(size);
+    std::vector<float> fvz(size);
+    std::vector<SGP4::Status> status(size);
+    std::vector<Eci> expected;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        models.push_back(SGP4(catalog[i]));
+        expected.push_back(Eci(epoch, 0.0, 0.0, 0.0));
+    }
+
+    std::vector<SGP4::Status> expected_status(size);
+    DateTime start = DateTime::Now(true);
+    for (size_t t = 0; t < n; t++)
+    {
+        const double tsince = static_cast<double>(t) * 60.0;
+        for (size_t i = 0; i < size; i++)
+        {
+            expected_status[i] = models[i].TryFindPosition(tsince,
+                    expected[i]);
+        }
+    }
+    const double scalar = Elapsed(start);
+
+    const SatelliteBatch batch(catalog);
+
+    start = DateTime::Now(true);
+    for (size_t t = 0; t < n; t++)
+    {
+        batch.FindPositions(epoch.AddHours(static_cast<double>(t)),
+                &x[0], &y[0], &z[0], &vx[0], &vy[0], &vz[0], &status[0]);
+    }
+    const double full = Elapsed(start);
+
+    start = DateTime::Now(true);
+    for (size_t t = 0; t < n; t++)
+    {
+        batch.FindPositions(epoch.AddHours(static_cast<double>(t)),
+                &fx[0], &fy[0], &fz[0], &fvx[0], &fvy[0], &fvz[0],
+                &status[0]);
+    }
+    const double single = Elapsed(start);
+
+    /*
+     * the last hour is still in the buffers, compare it with SGP4
+     */
+    batch.FindPositions(epoch.AddHours(static_cast<double>(n - 1)),
+            &x[0], &y[0], &z[0], &vx[0], &vy[0], &vz[0], &status[0]);
+
+    size_t ok = 0;
+    size_t mismatched = 0;
+    double worst = 0.0;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (status[i] != expected_status[i])
+        {
+            mismatched++;
+        }
+        else if (status[i] == SGP4::STATUS_OK)
+        {
+            const double error = (expected[i].Position()
+                    - Vector(x[i], y[i], z[i])).Magnitude();
+            worst = error > worst ? error : worst;
+            ok++;
+        }
+    }
+
+    std::cout << size << " near earth satellites, " << ok << " propagated, "
+        << mismatched << " status differences, worst " << std::scientific
+        << std::setprecision(2) << worst << " km from SGP4" << std::endl;
+    Report("SGP4 catalog", scalar, count);
+    Report("SatelliteBatch double", full, count);
+    Report("SatelliteBatch float", single, count);
+}
+
+/*
+ * the newton-raphson solution used by SGP4, for comparison
+ */
+void SolveNewtonRaphson(
+        const double capu,
+        const double axn,
+        const double ayn,
+        double& sinepw,
+        double& cosepw,
+        double& ecose,
+        double& esine)
+{
+    const double max_newton_naphson = 1.25 * sqrt(axn * axn + ayn * ayn);
+    double epw = capu;
+
+    for (int i = 0; i < 10; i++)
+    {
+        sinepw = sin(epw);
+        cosepw = cos(epw);
+        ecose = axn * cosepw + ayn * sinepw;
+        esine = axn * sinepw - ayn * cosepw;
+
+        const double f = capu - epw + esine;
+
+        if (fabs(f) < 1.0e-12)
+        {
+            break;
+        }
+
+        const double fdot = 1.0 - ecose;
+        double delta_epw = f / fdot;
+
+        if (i == 0)
+        {
+            if (delta_epw > max_newton_naphson)
+            {
+                delta_epw = max_newton_naphson;
+            }
+            else if (delta_epw < -max_newton_naphson)
+            {
+                delta_epw = -max_newton_naphson;
+            }
+        }
+        else
+        {
+            delta_epw = f / (fdot + 0.5 * esine * delta_epw);
+        }
+
+        epw += delta_epw;
+    }
+}
+
+/*
+ * @returns the largest residual of keplers equation
+ */
+double KeplerResidual(
+        const std::vector<double>& capu,
+        const std::vector<double>& sinepw,
+        const std::vector<double>& cosepw,
+        const std::vector<double>& esine)
+{
+    double worst = 0.0;
+
+    for (size_t i = 0; i < capu.size(); i++)
+    {
+        /*
+         * recover epw from its sine and cosine, on the same revolution as
+         * capu
+         */
+        double epw = atan2(sinepw[i], cosepw[i]);
+        epw += kTWOPI * floor((capu[i] - epw) / kTWOPI + 0.5);
+
+        const double f = fabs(capu[i] - epw + esine[i]);
+        worst = f > worst ? f : worst;
+    }
+
+    return worst;
+}
+
+/*
+ * time solving keplers equation over the range of mean anomaly for a
+ * series of eccentricities, comparing KeplerSolver with newton-raphson
+ */
+void BenchmarkKepler()
+{
+    static const double eccentricities[] =
+    {
+        0.0001, 0.01, 0.1, 0.5, 0.74, 0.9, 0.99, 0.999, 0.99999, 0.999999
+    };
+    const size_t n = 10000;
+    std::vector<double> capu(n);
+    std::vector<double> axn(n);
+    std::vector<double> ayn(n);
+    std::vector<double> sinepw(n);
+    std::vector<double> cosepw(n);
+    std::vector<double> ecose(n);
+    std::vector<double> esine(n);
+
+    for (size_t k = 0; k < sizeof(eccentricities) / sizeof(double); k++)
+    {
+        const double e = eccentricities[k];
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const double omega = kTWOPI * static_cast<double>(i % 97) / 97.0;
+            capu[i] = kTWOPI * static_cast<double>(i) / n - kPI;
+            axn[i] = e * cos(omega);
+            ayn[i] = e * sin(omega);
+        }
+
+        DateTime start = DateTime::Now(true);
+        for (int r = 0; r < kRepeat; r++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                SolveNewtonRaphson(capu[i], axn[i], ayn[i],
+                        sinepw[i], cosepw[i], ecose[i], esine[i]);
+            }
+        }
+        const double newton = Elapsed(start);
+        const double newton_residual
+            = KeplerResidual(capu, sinepw, cosepw, esine);
+
+        start = DateTime::Now(true);
+        for (int r = 0; r < kRepeat; r++)
+        {
+            KeplerSolver::Solve(n, &capu[0], &axn[0], &ayn[0],
+                    &sinepw[0], &cosepw[0], &ecose[0], &esine[0]);
+        }
+        const double solver = Elapsed(start);
+        const double solver_residual
+            = KeplerResidual(capu, sinepw, cosepw, esine);
+
+        std::ostringstream name;
+        name << "kepler e=" << e;
+
+        std::cout << std::setw(24) << std::left << name.str() << std::right
+            << std::setprecision(1) << std::fixed
+            << " newton " << std::setw(8)
+            << newton * 1.0e9 / static_cast<double>(kRepeat * n) << " ns"
+            << std::scientific
+            << " (" << newton_residual << ")"
+            << std::fixed
+            << " solver " << std::setw(8)
+            << solver * 1.0e9 / static_cast<double>(kRepeat * n) << " ns"
+            << std::scientific
+            << " (" << solver_residual << ")" << std::endl;
+    }
+}
+
+/*
+ * fit each satellite over a day from its epoch, then compare evaluating the
+ * fits at one minute steps with propagating directly, and report the worst
+ * error half way between the steps
+ */
+void BenchmarkChebyshev(const std::vector<Tle>& tles)
+{
+    const size_t n = 1440;
+    const TimeSpan step(0, 1, 0);
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    std::vector<double> z(n);
+    std::vector<double> vx(n);
+    std::vector<double> vy(n);
+    std::vector<double> vz(n);
+    std::vector<SGP4::Status> status(n);
+
+    std::vector<SGP4> models;
+    std::vector<ChebyshevEphemeris> fits;
+    size_t segments = 0;
+    size_t bytes = 0;
+
+    DateTime start = DateTime::Now(true);
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        const SGP4 model(tles[i]);
+        const DateTime epoch = tles[i].Epoch();
+
+        try
+        {
+            fits.push_back(ChebyshevEphemeris(model, epoch,
+                        epoch.AddMinutes(static_cast<double>(n))));
+            models.push_back(model);
+            segments += fits.back().Segments();
+            bytes += fits.back().Bytes();
+        }
+        catch (std::exception&)
+        {
+            /*
+             * decays within the day
+             */
+        }
+    }
+    const double fit = Elapsed(start);
+
+    const size_t count = kRepeat * n * fits.size();
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            models[i].FindPositions(fits[i].Start(), step, n,
+                    &x[0], &y[0], &z[0], &vx[0], &vy[0], &vz[0], &status[0]);
+        }
+    }
+    const double direct = Elapsed(start);
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < fits.size(); i++)
+        {
+            fits[i].FindPositions(fits[i].Start(), step, n,
+                    &x[0], &y[0], &z[0], &vx[0], &vy[0], &vz[0]);
+        }
+    }
+    const double evaluate = Elapsed(start);
+
+    double position = 0.0;
+    double velocity = 0.0;
+    for (size_t i = 0; i < fits.size(); i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            const DateTime dt = fits[i].Start().AddMinutes(
+                    static_cast<double>(j) + 0.5);
+            const Eci expected = models[i].FindPosition(dt);
+            const Eci actual = fits[i].FindPosition(dt);
+            const double dr = (actual.Position() - expected.Position())
+                .Magnitude();
+            const double dv = (actual.Velocity() - expected.Velocity())
+                .Magnitude();
+            position = dr > position ? dr : position;
+            velocity = dv > velocity ? dv : velocity;
+        }
+    }
+
+    std::cout << fits.size() << " satellites fitted over a day in "
+        << std::setprecision(3) << std::fixed << fit * 1.0e3 << " ms, "
+        << segments << " segments, "
+        << bytes / fits.size() << " bytes per satellite" << std::endl;
+    Report("SGP4 one day at one minute steps", direct, count);
+    Report("ChebyshevEphemeris", evaluate, count);
+    std::cout << "worst chebyshev error " << std::setprecision(6)
+        << position << " km " << velocity * 1.0e3 << " m/s" << std::endl;
+}
+
+/*
+ * elevation of a satellite from the observer, either propagated directly or
+ * interpolated from a cache
+ */
+double Elevation(
+        Observer& obs,
+        const SGP4& model,
+        TrajectoryCache* cache,
+        const unsigned int norad_number,
+        const DateTime& dt)
+{
+    if (cache == NULL)
+    {
+        return obs.GetLookAngle(model.FindPosition(dt)).elevation;
+    }
+    const Eci eci = cache->FindPosition(norad_number, TimeSpan(0, 1, 0), dt);
+    return obs.GetLookAngle(eci).elevation;
+}
+
+/*
+ * find every horizon crossing over a day, scanning at three minute steps
+ * and bisecting each crossing to a millisecond, writing the crossing times
+ * in minutes since start
+ * @returns the number of elevations found
+ */
+size_t RefinePasses(
+        Observer& obs,
+        const SGP4& model,
+        TrajectoryCache* cache,
+        const unsigned int norad_number,
+        const DateTime& start,
+        std::vector<double>& crossings)
+{
+    crossings.clear();
+    double previous = Elevation(obs, model, cache, norad_number, start);
+    size_t count = 1;
+
+    for (int minute = 3; minute <= 1440; minute += 3)
+    {
+        const double current = Elevation(obs, model, cache, norad_number,
+                start.AddMinutes(minute));
+        count++;
+
+        if ((previous > 0.0) != (current > 0.0))
+        {
+            double low = minute - 3.0;
+            double high = minute;
+
+            while (high - low > 1.0 / 60000.0)
+            {
+                const double middle = 0.5 * (low + high);
+                const double elevation = Elevation(obs, model, cache,
+                        norad_number, start.AddMinutes(middle));
+                count++;
+
+                if ((elevation > 0.0) == (previous > 0.0))
+                {
+                    low = middle;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            crossings.push_back(low);
+        }
+        previous = current;
+    }
+
+    return count;
+}
+
+/*
+ * compare refining horizon crossings from an observer by propagating each
+ * step against interpolating a one minute cache, and time filling the cache
+ * for the whole catalog with one and four threads
+ */
+void BenchmarkTrajectoryCache(const std::vector<Tle>& tles)
+{
+    Observer obs(51.507406923983446, -0.12773752212524414, 0.05);
+    const TimeSpan step(0, 1, 0);
+    std::vector<Tle> near;
+    std::vector<SGP4> models;
+
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        if (OrbitalElements(tles[i]).Period() < 225.0)
+        {
+            try
+            {
+                const SGP4 model(tles[i]);
+                model.FindPosition(1440.0);
+                models.push_back(model);
+                near.push_back(tles[i]);
+            }
+            catch (std::exception&)
+            {
+                /*
+                 * decays within the day
+                 */
+            }
+        }
+    }
+
+    std::vector<double> direct_crossings;
+    std::vector<double> cache_crossings;
+    double worst = 0.0;
+    size_t crossings = 0;
+    size_t count = 0;
+
+    DateTime start = DateTime::Now(true);
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        count += RefinePasses(obs, models[i], NULL, 0, near[i].Epoch(),
+                direct_crossings);
+        crossings += direct_crossings.size();
+    }
+    const double direct = Elapsed(start);
+
+    TrajectoryCache cache;
+    for (size_t i = 0; i < near.size(); i++)
+    {
+        cache.Add(near[i]);
+    }
+
+    /*
+     * the first pass propagates the blocks it needs, later passes, for
+     * example for other observers, only interpolate
+     */
+    start = DateTime::Now(true);
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        RefinePasses(obs, models[i], &cache, near[i].NoradNumber(),
+                near[i].Epoch(), cache_crossings);
+    }
+    const double cold = Elapsed(start);
+
+    start = DateTime::Now(true);
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        RefinePasses(obs, models[i], &cache, near[i].NoradNumber(),
+                near[i].Epoch(), cache_crossings);
+    }
+    const double warm = Elapsed(start);
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        RefinePasses(obs, models[i], NULL, 0, near[i].Epoch(),
+                direct_crossings);
+        RefinePasses(obs, models[i], &cache, near[i].NoradNumber(),
+                near[i].Epoch(), cache_crossings);
+
+        for (size_t j = 0; j < direct_crossings.size()
+                && j < cache_crossings.size(); j++)
+        {
+            const double diff = fabs(direct_crossings[j] - cache_crossings[j]);
+            worst = diff > worst ? diff : worst;
+        }
+    }
+
+    std::cout << models.size() << " near earth satellites, " << crossings
+        << " horizon crossings refined" << std::endl;
+    Report("SGP4 pass refinement", direct, count);
+    Report("TrajectoryCache pass refinement, cold", cold, count);
+    Report("TrajectoryCache pass refinement, warm", warm, count);
+    std::cout << "worst crossing difference " << std::setprecision(3)
+        << worst * 60.0e3 << " ms" << std::endl;
+
+    TrajectoryCache full;
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        try
+        {
+            full.Add(tles[i]);
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
+    const DateTime epoch = tles[0].Epoch();
+    const DateTime end = epoch.AddDays(7.0);
+
+    start = DateTime::Now(true);
+    full.Fill(step, epoch, end, 1);
+    const double one = Elapsed(start);
+    const size_t samples = full.Samples();
+
+    full.Clear();
+    start = DateTime::Now(true);
+    full.Fill(step, epoch, end, 4);
+    const double four = Elapsed(start);
+
+    Report("TrajectoryCache fill, 1 thread", one, samples);
+    Report("TrajectoryCache fill, 4 threads", four, samples);
+}
+
+/*
+ * write a day of one minute samples for the catalog to an ephemeris file,
+ * then compare looking up positions half way between samples in the mapped
+ * file with propagating to them
+ */
+void BenchmarkEphemerisFile(const std::vector<Tle>& tles)
+{
+    const char* file_name = "benchmark.eph";
+    const size_t samples = 1441;
+    const DateTime epoch = tles[0].Epoch();
+    std::vector<SGP4> models;
+    std::vector<unsigned int> norad_numbers;
+    std::vector<DateTime> epochs;
+
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        bool duplicate = false;
+        for (size_t j = 0; j < norad_numbers.size(); j++)
+        {
+            duplicate = duplicate || norad_numbers[j] == tles[i].NoradNumber();
+        }
+
+        try
+        {
+            if (!duplicate)
+            {
+                models.push_back(SGP4(tles[i]));
+                norad_numbers.push_back(tles[i].NoradNumber());
+                epochs.push_back(tles[i].Epoch());
+            }
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
+    DateTime start = DateTime::Now(true);
+    {
+        EphemerisWriter writer(file_name, epoch, TimeSpan(0, 1, 0), samples);
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            writer.Write(norad_numbers[i], models[i]);
+        }
+        writer.Close();
+    }
+    const double write = Elapsed(start);
+
+    start = DateTime::Now(true);
+    const EphemerisReader reader(file_name);
+    const double open = Elapsed(start);
+
+    size_t count = 0;
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            const EphemerisFile::Record* records =
+                reader.Records(norad_numbers[i]);
+            for (size_t j = 0; j + 1 < samples; j++)
+            {
+                if (records[j].status == SGP4::STATUS_OK
+                        && records[j + 1].status == SGP4::STATUS_OK)
+                {
+                    const DateTime dt = epoch.AddMinutes(
+                            static_cast<double>(j) + 0.5);
+                    reader.FindPosition(norad_numbers[i], dt);
+                    count++;
+                }
+            }
+        }
+    }
+    const double lookup = Elapsed(start);
+
+    /*
+     * some verification cases break down without an error, leave any which
+     * go further than 100000 km out of the error
+     */
+    std::vector<bool> valid(models.size(), true);
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const EphemerisFile::Record* records =
+            reader.Records(norad_numbers[i]);
+        for (size_t j = 0; j < samples; j++)
+        {
+            valid[i] = valid[i] && fabs(records[j].x) < 1.0e5
+                && fabs(records[j].y) < 1.0e5 && fabs(records[j].z) < 1.0e5;
+        }
+    }
+
+    double position = 0.0;
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            const EphemerisFile::Record* records =
+                reader.Records(norad_numbers[i]);
+            for (size_t j = 0; j + 1 < samples; j++)
+            {
+                if (records[j].status == SGP4::STATUS_OK
+                        && records[j + 1].status == SGP4::STATUS_OK)
+                {
+                    const DateTime dt = epoch.AddMinutes(
+                            static_cast<double>(j) + 0.5);
+                    Eci eci(dt, 0.0, 0.0, 0.0);
+                    const SGP4::Status status = models[i].TryFindPosition(
+                            (dt - epochs[i]).TotalMinutes(), eci);
+
+                    if (r == 0 && valid[i] && status == SGP4::STATUS_OK)
+                    {
+                        const double dr = (eci.Position()
+                                - reader.FindPosition(norad_numbers[i], dt)
+                                .Position()).Magnitude();
+                        position = dr > position ? dr : position;
+                    }
+                }
+            }
+        }
+    }
+    const double direct = Elapsed(start);
+
+    std::cout << reader.Satellites() << " satellites written to "
+        << file_name << " in " << std::setprecision(3) << std::fixed
+        << write * 1.0e3 << " ms, mapped in " << open * 1.0e6 << " us"
+        << std::endl;
+    Report("SGP4 half way between samples", direct, count);
+    Report("EphemerisReader", lookup, count);
+    std::cout << "worst interpolation error " << std::setprecision(6)
+        << position << " km" << std::endl;
+
+    std::remove(file_name);
+}
+
+/*
+ * a request stream where many clients ask for the same few times, served
+ * by propagating each request and through a PropagationCache
+ */
+void BenchmarkPropagationCache(const std::vector<Tle>& tles)
+{
+    const size_t times = 60;
+    const size_t requests = 200000;
+    std::vector<SGP4> models;
+
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        try
+        {
+            const SGP4 model(tles[i]);
+            for (size_t j = 0; j < times; j++)
+            {
+                model.FindPosition(static_cast<double>(j));
+            }
+            models.push_back(model);
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
+    /*
+     * a fixed pseudo random sequence of (satellite, time) requests
+     */
+    std::vector<size_t> satellite(requests);
+    std::vector<size_t> time(requests);
+    unsigned long long state = 12345;
+    for (size_t i = 0; i < requests; i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        satellite[i] = static_cast<size_t>(state >> 33) % models.size();
+        time[i] = static_cast<size_t>(state >> 17) % times;
+    }
+
+    double worst = 0.0;
+
+    DateTime start = DateTime::Now(true);
+    for (size_t i = 0; i < requests; i++)
+    {
+        const SGP4& model = models[satellite[i]];
+        model.FindPosition(model.Elements().Epoch().AddMinutes(
+                    static_cast<double>(time[i])));
+    }
+    const double direct = Elapsed(start);
+
+    PropagationCache cache(4096);
+
+    start = DateTime::Now(true);
+    for (size_t i = 0; i < requests; i++)
+    {
+        const SGP4& model = models[satellite[i]];
+        cache.FindPosition(model, model.Elements().Epoch().AddMinutes(
+                    static_cast<double>(time[i])));
+    }
+    const double cached = Elapsed(start);
+    const unsigned long long hits = cache.Hits();
+    const unsigned long long misses = cache.Misses();
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        for (size_t j = 0; j < times; j++)
+        {
+            const DateTime dt = models[i].Elements().Epoch().AddMinutes(
+                    static_cast<double>(j));
+            const double dr = (cache.FindPosition(models[i], dt).Position()
+                    - models[i].FindPosition(dt).Position()).Magnitude();
+            worst = dr > worst ? dr : worst;
+        }
+    }
+
+    std::cout << requests << " requests for " << models.size()
+        << " satellites at " << times << " times, "
+        << hits << " hits, " << misses << " misses, "
+        << "worst difference " << worst << " km" << std::endl;
+    Report("SGP4 requests", direct, requests, "request");
+    Report("PropagationCache requests", cached, requests, "request");
+}
+
+void BenchmarkCatalog(const std::vector<Tle>& tles)
+{
+    const char* file_name = "benchmark.tle";
+    const size_t objects = 30000;
+
+    {
+        std::ofstream file(file_name);
+        for (size_t i = 0; i < objects; i++)
+        {
+            const Tle& tle = tles[i % tles.size()];
+            file << "0 OBJECT " << i << "\r\n"
+                << WithChecksum(tle.Line1()) << "\r\n"
+                << WithChecksum(tle.Line2()) << "\r\n";
+        }
+    }
+
+    /*
+     * the usual way, line by line through strings
+     */
+    DateTime start = DateTime::Now(true);
+    std::vector<Tle> loaded;
+    {
+        std::ifstream file(file_name);
+        std::string name;
+        std::string line1;
+        std::string line2;
+        while (std::getline(file, name)
+                && std::getline(file, line1)
+                && std::getline(file, line2))
+        {
+            Util::Trim(name);
+            Util::Trim(line1);
+            Util::Trim(line2);
+            loaded.push_back(Tle(name, line1, line2));
+        }
+    }
+    const double lines = Elapsed(start);
+
+    start = DateTime::Now(true);
+    const TleCatalog catalog(file_name);
+    const double mapped = Elapsed(start);
+
+    size_t differences = 0;
+    for (size_t i = 0; i < catalog.Size() && i < loaded.size(); i++)
+    {
+        const Tle a(catalog[i]);
+        const Tle& b = loaded[i];
+        if (a.NoradNumber() != b.NoradNumber()
+                || a.Epoch() != b.Epoch()
+                || a.BStar() != b.BStar()
+                || a.Eccentricity() != b.Eccentricity()
+                || a.MeanMotion() != b.MeanMotion()
+                || a.Line2() != b.Line2()
+                || a.Name() != b.Name().substr(2))
+        {
+            differences++;
+        }
+    }
+
+    std::cout << catalog.Size() << " of " << objects
+        << " element sets loaded, " << catalog.Rejected().size()
+        << " rejected, " << differences << " differences" << std::endl;
+    Report("getline and Tle", lines, objects, "element set");
+    Report("TleCatalog", mapped, objects, "element set");
+
+    std::cout << "TleRecord " << sizeof(TleRecord) << " bytes" << std::endl;
+
+    start = DateTime::Now(true);
+    const SatelliteCatalog from_tles(loaded);
+    const double tle_models = Elapsed(start);
+
+    start = DateTime::Now(true);
+    const SatelliteCatalog from_records(catalog.Records());
+    const double record_models = Elapsed(start);
+
+    Report("SatelliteCatalog from Tle", tle_models, objects, "element set");
+    Report("SatelliteCatalog from TleRecord", record_models, objects,
+            "element set");
+
+    std::remove(file_name);
+}
+
+void BenchmarkSatelliteCatalog(const std::vector<Tle>& tles)
+{
+    const size_t objects = 30000;
+    std::vector<Tle> catalog;
+
+    for (size_t i = 0; i < objects; i++)
+    {
+        catalog.push_back(tles[i % tles.size()]);
+    }
+
+    DateTime start = DateTime::Now(true);
+    std::vector<SGP4> models;
+    size_t failed = 0;
+    for (size_t i = 0; i < catalog.size(); i++)
+    {
+        try
+        {
+            models.push_back(SGP4(catalog[i]));
+        }
+        catch (std::exception&)
+        {
+            failed++;
+        }
+    }
+    const double serial = Elapsed(start);
+
+    std::cout << models.size() << " of " << objects
+        << " satellites initialised, " << failed << " failed" << std::endl;
+    Report("SGP4 constructors", serial, objects, "satellite");
+
+    for (unsigned int threads = 1; threads <= 4; threads *= 2)
+    {
+        start = DateTime::Now(true);
+        const SatelliteCatalog built(catalog, threads);
+        const double elapsed = Elapsed(start);
+
+        std::ostringstream name;
+        name << "SatelliteCatalog, " << threads << " threads";
+        Report(name.str(), elapsed, objects, "satellite");
+
+        if (built.Size() != models.size()
+                || built.Errors().size() != failed)
+        {
+            std::cout << "SatelliteCatalog results differ" << std::endl;
+        }
+    }
+}
+
+void BenchmarkCatalogStore(const std::vector<Tle>& tles)
+{
+    const size_t lookups = 1000000;
+    CatalogStore store;
+    const SatelliteCatalog catalog(tles);
+
+    DateTime start = DateTime::Now(true);
+    const size_t published = store.Update(catalog);
+    const double update = Elapsed(start);
+
+    /*
+     * a snapshot per lookup, as a server would take one per request
+     */
+    size_t found = 0;
+    start = DateTime::Now(true);
+    for (size_t i = 0; i < lookups; i++)
+    {
+        const CatalogStore::Snapshot snapshot(store);
+        if (snapshot.Find(tles[i % tles.size()].NoradNumber()) != NULL)
+        {
+            found++;
+        }
+    }
+    const double lookup = Elapsed(start);
+
+    std::cout << published << " satellites published, " << found
+        << " of " << lookups << " lookups found" << std::endl;
+    Report("CatalogStore update", update, published, "satellite");
+    Report("CatalogStore snapshot and find", lookup, lookups, "lookup");
+}
+
+void BenchmarkModelSnapshot(const std::vector<Tle>& tles)
+{
+    const char* file_name = "benchmark.mdl";
+    const size_t objects = 30000;
+    std::vector<Tle> catalog;
+
+    for (size_t i = 0; i < objects; i++)
+    {
+        catalog.push_back(tles[i % tles.size()]);
+    }
+
+    DateTime start = DateTime::Now(true);
+    const SatelliteCatalog built(catalog);
+    const double initialise = Elapsed(start);
+
+    start = DateTime::Now(true);
+    ModelSnapshot::Write(file_name, built.Models());
+    const double write = Elapsed(start);
+
+    start = DateTime::Now(true);
+    std::vector<SGP4> models;
+    {
+        const ModelSnapshot snapshot(file_name);
+        models = snapshot.Models();
+    }
+    const double load = Elapsed(start);
+
+    /*
+     * the restored models should propagate exactly as the originals
+     */
+    size_t differences = 0;
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        for (int j = -1440; j <= 1440; j += 360)
+        {
+            Eci expected(DateTime(), 0.0, 0.0, 0.0);
+            Eci actual(DateTime(), 0.0, 0.0, 0.0);
+            const SGP4::Status status = built[i].TryFindPosition(
+                    static_cast<double>(j), expected);
+
+            if (models[i].TryFindPosition(static_cast<double>(j), actual)
+                    != status
+                    || (status == SGP4::STATUS_OK
+                        && ((expected.Position() - actual.Position())
+                            .Magnitude() != 0.0
+                            || (expected.Velocity() - actual.Velocity())
+                            .Magnitude() != 0.0)))
+            {
+                differences++;
+            }
+        }
+    }
+
+    std::cout << models.size() << " models restored, " << differences
+        << " differences" << std::endl;
+    Report("SatelliteCatalog", initialise, built.Size(), "satellite");
+    Report("ModelSnapshot write", write, built.Size(), "satellite");
+    Report("ModelSnapshot load", load, models.size(), "satellite");
+
+    std::remove(file_name);
+}
+
+void BenchmarkPipeline(const std::vector<Tle>& tles)
+{
+    const char* file_name = "benchmark.tle";
+    const size_t objects = 3000;
+
+    {
+        std::ofstream file(file_name);
+        for (size_t i = 0; i < objects; i++)
+        {
+            const Tle& tle = tles[i % tles.size()];
+            file << tle.Line1() << "\n" << tle.Line2() << "\n";
+        }
+    }
+
+    /*
+     * a day at ten minute steps for each element set, written to nowhere
+     */
+    const TlePipeline::Propagator propagator(0.0, 1440.0, 10.0);
+
+    for (unsigned int threads = 1; threads <= 4; threads *= 2)
+    {
+        TleStream input(file_name);
+        std::ofstream output("/dev/null");
+        const TlePipeline pipeline(propagator, threads);
+
+        const DateTime start = DateTime::Now(true);
+        const size_t processed = pipeline.Run(input, output);
+        const double elapsed = Elapsed(start);
+
+        std::ostringstream name;
+        name << "TlePipeline, " << threads << " threads";
+        Report(name.str(), elapsed, processed, "element set");
+    }
+
+    std::remove(file_name);
+}
+
+void BenchmarkOmmCatalog(const std::vector<Tle>& tles)
+{
+    const char* file_name = "benchmark.csv";
+    const size_t objects = 30000;
+
+    {
+        std::ofstream file(file_name);
+        file << "OBJECT_NAME,EPOCH,MEAN_MOTION,ECCENTRICITY,INCLINATION,"
+            << "RA_OF_ASC_NODE,ARG_OF_PERICENTER,MEAN_ANOMALY,NORAD_CAT_ID,"
+            << "BSTAR\r\n" << std::setprecision(17);
+        for (size_t i = 0; i < objects; i++)
+        {
+            const Tle& tle = tles[i % tles.size()];
+            std::string epoch = tle.Epoch().ToString().substr(0, 26);
+            epoch[10] = 'T';
+            file << "OBJECT " << i << "," << epoch
+                << "," << tle.MeanMotion()
+                << "," << tle.Eccentricity()
+                << "," << tle.Inclination(true)
+                << "," << tle.RightAscendingNode(true)
+                << "," << tle.ArgumentPerigee(true)
+                << "," << tle.MeanAnomaly(true)
+                << "," << tle.NoradNumber()
+                << "," << tle.BStar() << "\r\n";
+        }
+    }
+
+    const DateTime start = DateTime::Now(true);
+    const OmmCatalog catalog(file_name);
+    const double elapsed = Elapsed(start);
+
+    /*
+     * the elements should be exactly those read from the element sets
+     */
+    size_t differences = 0;
+    for (size_t i = 0; i < catalog.Size(); i++)
+    {
+        const OrbitalElements expected(tles[i % tles.size()]);
+        const OrbitalElements& actual = catalog[i];
+
+        if (expected.Epoch() != actual.Epoch()
+                || expected.MeanMotion() != actual.MeanMotion()
+                || expected.Eccentricity() != actual.Eccentricity()
+                || expected.Inclination() != actual.Inclination()
+                || expected.AscendingNode() != actual.AscendingNode()
+                || expected.ArgumentPerigee() != actual.ArgumentPerigee()
+                || expected.MeanAnomoly() != actual.MeanAnomoly()
+                || expected.BStar() != actual.BStar())
+        {
+            differences++;
+        }
+    }
+
+    std::cout << catalog.Size() << " of " << objects << " messages loaded, "
+        << catalog.Rejected().size() << " rejected, " << differences
+        << " differences" << std::endl;
+    Report("OmmCatalog", elapsed, objects, "message");
+
+    std::remove(file_name);
+}
+
+void BenchmarkTleArchive(const std::vector<Tle>& tles)
+{
+    const char* text_name = "benchmark.tle";
+    const char* archive_name = "benchmark.tla";
+    const size_t objects = 200000;
+    const size_t lookups = 1000000;
+
+    /*
+     * a history for each satellite, with an element set every hour and
+     * every element set given twice
+     */
+    {
+        std::ofstream file(text_name);
+        for (size_t i = 0; i < objects; i++)
+        {
+            const Tle& tle = tles[i % tles.size()];
+            const size_t set = (i / tles.size()) % (objects / tles.size() / 2);
+            std::ostringstream epoch;
+            epoch << "20" << std::setfill('0') << std::setw(3)
+                << 1 + set / 24 << "." << std::setw(8) << (set % 24) * 4166667;
+
+            std::string line1 = tle.Line1();
+            line1.replace(18, 14, epoch.str());
+            file << WithChecksum(line1) << "\n"
+                << WithChecksum(tle.Line2()) << "\n";
+        }
+    }
+
+    DateTime start = DateTime::Now(true);
+    size_t stored;
+    {
+        TleStream input(text_name);
+        stored = TleArchive::Build(input, archive_name, 1 << 14);
+    }
+    const double build = Elapsed(start);
+
+    const TleArchive archive(archive_name);
+    const DateTime first(2020, 1, 1);
+    size_t found = 0;
+
+    start = DateTime::Now(true);
+    for (size_t i = 0; i < lookups; i++)
+    {
+        const DateTime date =
+            first.AddHours(static_cast<double>(i % 3000));
+        if (archive.Find(tles[i % tles.size()].NoradNumber(), date) != NULL)
+        {
+            found++;
+        }
+    }
+    const double find = Elapsed(start);
+
+    std::cout << stored << " of " << objects << " element sets stored for "
+        << archive.Satellites() << " satellites, " << found << " of "
+        << lookups << " lookups found" << std::endl;
+    Report("TleArchive build", build, objects, "element set");
+    Report("TleArchive find", find, lookups, "lookup");
+
+    std::remove(text_name);
+    std::remove(archive_name);
+}
+
+/*
+ * look angles and geodetic positions of a catalog at one instant, finding
+ * the sidereal time for each conversion and once through a time context
+ */
+void BenchmarkTimeContext(const std::vector<Tle>& tles)
+{
+    const size_t objects = 30000;
+    const DateTime date(2013, 6, 1, 12, 0, 0);
+    std::vector<Eci> positions;
+
+    /*
+     * the positions only need to be spread around the earth, so each
+     * satellite is propagated a different time from its epoch and the
+     * result is taken to be at date
+     */
+    for (size_t i = 0; i < objects; i++)
+    {
+        const SGP4 model(tles[i % tles.size()]);
+        Eci eci(date, 0.0, 0.0, 0.0);
+
+        if (model.TryFindPosition(static_cast<double>(i % 1440), eci)
+                == SGP4::STATUS_OK)
+        {
+            positions.push_back(Eci(date, eci.Position(), eci.Velocity()));
+        }
+    }
+
+    Observer obs(51.507406923983446, -0.12773752212524414, 0.05);
+    std::vector<CoordTopocentric> expected_topo(positions.size());
+    std::vector<CoordGeodetic> expected_geo(positions.size());
+    std::vector<CoordTopocentric> actual_topo(positions.size());
+    std::vector<CoordGeodetic> actual_geo(positions.size());
+
+    DateTime start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            expected_topo[i] = obs.GetLookAngle(positions[i]);
+            expected_geo[i] = positions[i].ToGeodetic();
+        }
+    }
+    const double direct = Elapsed(start);
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        const TimeContext time(date);
+
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            actual_topo[i] = obs.GetLookAngle(positions[i], time);
+            actual_geo[i] = positions[i].ToGeodetic(time);
+        }
+    }
+    const double shared = Elapsed(start);
+
+    size_t differences = 0;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (expected_topo[i].azimuth != actual_topo[i].azimuth
+                || expected_topo[i].elevation != actual_topo[i].elevation
+                || expected_topo[i].range != actual_topo[i].range
+                || expected_topo[i].range_rate != actual_topo[i].range_rate
+                || expected_geo[i].latitude != actual_geo[i].latitude
+                || expected_geo[i].longitude != actual_geo[i].longitude
+                || expected_geo[i].altitude != actual_geo[i].altitude)
+        {
+            differences++;
+        }
+    }
+
+    std::cout << positions.size() << " positions at one instant, "
+        << differences << " differences" << std::endl;
+    const size_t count = kRepeat * positions.size();
+    Report("GetLookAngle and ToGeodetic", direct, count);
+    Report("with TimeContext", shared, count);
+}
+
+/*
+ * a day of look angles at one minute steps per satellite, stepping a
+ * DateTime and converting each position, and through a time grid
+ */
+void BenchmarkTimeGrid(const std::vector<Tle>& tles)
+{
+    const size_t n = 1440;
+    const TimeSpan step(0, 1, 0);
+    Observer obs(51.507406923983446, -0.12773752212524414, 0.05);
+    std::vector<SGP4> models;
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    std::vector<double> z(n);
+    std::vector<double> vx(n);
+    std::vector<double> vy(n);
+    std::vector<double> vz(n);
+    std::vector<SGP4::Status> status(n);
+
+    /*
+     * only satellites which propagate over the whole day, so that the
+     * direct loop does not throw
+     */
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        const SGP4 model(tles[i]);
+        const TimeGrid grid(tles[i].Epoch(), step, n);
+        model.FindPositions(grid, &x[0], &y[0], &z[0],
+                NULL, NULL, NULL, &status[0]);
+
+        size_t ok = 0;
+        while (ok < n && status[ok] == SGP4::STATUS_OK)
+        {
+            ok++;
+        }
+
+        if (ok == n)
+        {
+            models.push_back(model);
+        }
+    }
+
+    const size_t count = kRepeat * n * models.size();
+    std::vector<double> expected(4 * n * models.size());
+    std::vector<double> actual(4 * n * models.size());
+
+    DateTime start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t m = 0; m < models.size(); m++)
+        {
+            DateTime dt = models[m].Elements().Epoch();
+            double* result = &expected[4 * n * m];
+
+            for (size_t i = 0; i < n; i++)
+            {
+                const CoordTopocentric topo =
+                    obs.GetLookAngle(models[m].FindPosition(dt));
+                result[i] = topo.azimuth;
+                result[n + i] = topo.elevation;
+                result[2 * n + i] = topo.range;
+                result[3 * n + i] = topo.range_rate;
+                dt = dt + step;
+            }
+        }
+    }
+    const double direct = Elapsed(start);
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        for (size_t m = 0; m < models.size(); m++)
+        {
+            const TimeGrid grid(models[m].Elements().Epoch(), step, n);
+            double* result = &actual[4 * n * m];
+
+            models[m].FindPositions(grid, &x[0], &y[0], &z[0],
+                    &vx[0], &vy[0], &vz[0]);
+            obs.GetLookAngles(grid, &x[0], &y[0], &z[0],
+                    &vx[0], &vy[0], &vz[0],
+                    result, result + n, result + 2 * n, result + 3 * n);
+        }
+    }
+    const double gridded = Elapsed(start);
+
+    size_t differences = 0;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        if (expected[i] != actual[i])
+        {
+            differences++;
+        }
+    }
+
+    /*
+     * sidereal times alone
+     */
+    const TimeGrid grid(DateTime(2013, 1, 1, 0, 0, 0), TimeSpan(0, 0, 1),
+            86400);
+    std::vector<double> gmst(grid.Size());
+    double sum = 0.0;
+
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        DateTime dt = grid.Start();
+        for (size_t i = 0; i < grid.Size(); i++)
+        {
+            gmst[i] = dt.ToGreenwichSiderealTime();
+            dt = dt.AddSeconds(1.0);
+        }
+        sum += gmst[grid.Size() - 1];
+    }
+    const double stepped = Elapsed(start);
+
+    std::vector<double> batch(grid.Size());
+    start = DateTime::Now(true);
+    for (int r = 0; r < kRepeat; r++)
+    {
+        grid.SiderealTimes(&batch[0]);
+        sum += batch[grid.Size() - 1];
+    }
+    const double vectorised = Elapsed(start);
+
+    for (size_t i = 0; i < grid.Size(); i++)
+    {
+        if (gmst[i] != batch[i])
+        {
+            differences++;
+        }
+    }
+
+    std::cout << models.size() << " satellites over a day, "
+        << differences << " differences (" << sum << ")" << std::endl;
+    Report("FindPosition and GetLookAngle", direct, count);
+    Report("TimeGrid", gridded, count);
+    Report("ToGreenwichSiderealTime", stepped, kRepeat * grid.Size(), "time");
+    Report("TimeGrid::SiderealTimes", vectorised, kRepeat * grid.Size(),
+            "time");
+}
+
+int main()
+{
+    const char* file_name = "SGP4-VER.TLE";
+
+    const std::vector<TestCase> cases = LoadTestCases(file_name);
+
+    if (cases.empty())
+    {
+        return 1;
+    }
+
+    std::vector<Tle> tles;
+    for (size_t i = 0; i < cases.size(); i++)
+    {
+        tles.push_back(cases[i].tle);
+    }
+
+    std::cout << tles.size() << " satellites, "
+        << kRepeat << " repetitions" << std::endl;
+
+    BenchmarkPositionOnly(tles);
+    BenchmarkSinglePrecision(cases);
+    BenchmarkBatch(tles);
+    BenchmarkKepler();
+    BenchmarkChebyshev(tles);
+    BenchmarkTrajectoryCache(tles);
+    BenchmarkEphemerisFile(tles);
+    BenchmarkPropagationCache(tles);
+    BenchmarkCatalog(tles);
+    BenchmarkSatelliteCatalog(tles);
+    BenchmarkCatalogStore(tles);
+    BenchmarkModelSnapshot(tles);
+    BenchmarkPipeline(tles);
+    BenchmarkOmmCatalog(tles);
+    BenchmarkTleArchive(tles);
+    BenchmarkTimeContext(tles);
+    BenchmarkTimeGrid(tles);
+
+    return 0;
+}
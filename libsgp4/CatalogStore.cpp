@@ -0,0 +1,299 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CatalogStore.h"
+
+#include "Threads.h"
+
+#include <algorithm>
+#include <map>
+
+#include <sched.h>
+
+/*
+ * the epoch and the published table are read and written with the gcc
+ * atomic builtins, sequentially consistent so that a snapshot which sees
+ * an epoch also sees every table published before it
+ */
+
+CatalogStore::Snapshot::Snapshot(const CatalogStore& store)
+    : store_(store),
+    slot_(0),
+    table_(NULL)
+{
+    /*
+     * claim a free slot with the current epoch, before reading the table,
+     * so that no update frees the table while this snapshot can see it
+     */
+    for (;;)
+    {
+        for (size_t i = 0; i < kSnapshots; i++)
+        {
+            unsigned long long expected = 0;
+            const unsigned long long epoch =
+                __atomic_load_n(&store_.epoch_, __ATOMIC_SEQ_CST);
+
+            if (__atomic_compare_exchange_n(&store_.slots_[i].epoch,
+                        &expected, epoch, false,
+                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            {
+                slot_ = i;
+                table_ = __atomic_load_n(&store_.table_, __ATOMIC_SEQ_CST);
+                return;
+            }
+        }
+
+        sched_yield();
+    }
+}
+
+CatalogStore::Snapshot::~Snapshot()
+{
+    __atomic_store_n(&store_.slots_[slot_].epoch, 0ULL, __ATOMIC_SEQ_CST);
+}
+
+const CatalogStore::Entry* CatalogStore::Snapshot::Find(
+        const unsigned int norad_number) const
+{
+    const std::vector<unsigned int>& numbers = table_->norad_numbers;
+    const std::vector<unsigned int>::const_iterator itr =
+        std::lower_bound(numbers.begin(), numbers.end(), norad_number);
+
+    if (itr == numbers.end() || *itr != norad_number)
+    {
+        return NULL;
+    }
+
+    return table_->entries[static_cast<size_t>(itr - numbers.begin())];
+}
+
+size_t CatalogStore::Snapshot::Size() const
+{
+    return table_->entries.size();
+}
+
+const CatalogStore::Entry& CatalogStore::Snapshot::operator[](
+        const size_t i) const
+{
+    return *table_->entries[i];
+}
+
+CatalogStore::CatalogStore()
+    : table_(new Table),
+    epoch_(1)
+{
+    for (size_t i = 0; i < kSnapshots; i++)
+    {
+        slots_[i].epoch = 0;
+    }
+
+    pthread_mutex_init(&mutex_, NULL);
+}
+
+CatalogStore::~CatalogStore()
+{
+    for (size_t i = 0; i < table_->entries.size(); i++)
+    {
+        delete table_->entries[i];
+    }
+    delete table_;
+
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        for (size_t j = 0; j < retired_[i].entries.size(); j++)
+        {
+            delete retired_[i].entries[j];
+        }
+        delete retired_[i].table;
+    }
+
+    pthread_mutex_destroy(&mutex_);
+}
+
+size_t CatalogStore::Update(const SatelliteCatalog& catalog)
+{
+    std::vector<const SGP4*> models(catalog.Size());
+
+    for (size_t i = 0; i < catalog.Size(); i++)
+    {
+        models[i] = &catalog[i];
+    }
+
+    return Publish(models);
+}
+
+bool CatalogStore::Update(const Tle& tle)
+{
+    const SGP4 model(tle);
+
+    return Publish(std::vector<const SGP4*>(1, &model)) > 0;
+}
+
+size_t CatalogStore::Publish(const std::vector<const SGP4*>& models)
+{
+    Threads::ScopedLock lock(mutex_);
+
+    /*
+     * the newest elements given for each satellite
+     */
+    std::map<unsigned int, const SGP4*> updates;
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const OrbitalElements& elements = models[i]->Elements();
+        const SGP4*& newest = updates[elements.NoradNumber()];
+
+        if (newest == NULL || newest->Elements().Epoch() < elements.Epoch())
+        {
+            newest = models[i];
+        }
+    }
+
+    /*
+     * merge the updates into a copy of the index, both are in norad number
+     * order
+     */
+    const Table* old = table_;
+    Table* table = new Table;
+    std::vector<const Entry*> replaced;
+    std::map<unsigned int, const SGP4*>::const_iterator update =
+        updates.begin();
+    size_t i = 0;
+
+    table->norad_numbers.reserve(old->entries.size() + updates.size());
+    table->entries.reserve(old->entries.size() + updates.size());
+
+    while (i < old->entries.size() || update != updates.end())
+    {
+        if (update == updates.end()
+                || (i < old->entries.size()
+                    && old->norad_numbers[i] < update->first))
+        {
+            table->norad_numbers.push_back(old->norad_numbers[i]);
+            table->entries.push_back(old->entries[i]);
+            i++;
+            continue;
+        }
+
+        const Entry* current = NULL;
+        if (i < old->entries.size() && old->norad_numbers[i] == update->first)
+        {
+            current = old->entries[i];
+            i++;
+        }
+
+        const SGP4& model = *update->second;
+        const DateTime epoch = model.Elements().Epoch();
+
+        if (current != NULL && !(current->Epochs().back() < epoch))
+        {
+            /*
+             * not newer than the published elements
+             */
+            table->norad_numbers.push_back(update->first);
+            table->entries.push_back(current);
+        }
+        else
+        {
+            std::vector<DateTime> epochs;
+            if (current != NULL)
+            {
+                /*
+                 * keep the newest of the old epochs, leaving room for this
+                 * one
+                 */
+                const std::vector<DateTime>& history = current->Epochs();
+                const size_t keep = history.size() < kEpochs
+                    ? history.size() : kEpochs - 1;
+
+                epochs.reserve(keep + 1);
+                epochs.assign(history.end() - static_cast<long>(keep),
+                        history.end());
+                replaced.push_back(current);
+            }
+            epochs.push_back(epoch);
+
+            table->norad_numbers.push_back(update->first);
+            table->entries.push_back(new Entry(model, epochs));
+        }
+
+        ++update;
+    }
+
+    /*
+     * new satellites, and satellites with newer elements
+     */
+    const size_t published = table->entries.size() - old->entries.size()
+        + replaced.size();
+
+    if (published == 0)
+    {
+        delete table;
+        return 0;
+    }
+
+    __atomic_store_n(&table_, static_cast<const Table*>(table),
+            __ATOMIC_SEQ_CST);
+
+    Retired retired;
+    retired.epoch = __atomic_add_fetch(&epoch_, 1ULL, __ATOMIC_SEQ_CST);
+    retired.table = old;
+    retired.entries = replaced;
+    retired_.push_back(retired);
+
+    Reclaim();
+
+    return published;
+}
+
+/*
+ * free whatever was retired before the epoch of the oldest snapshot
+ */
+void CatalogStore::Reclaim()
+{
+    unsigned long long oldest = __atomic_load_n(&epoch_, __ATOMIC_SEQ_CST);
+
+    for (size_t i = 0; i < kSnapshots; i++)
+    {
+        const unsigned long long epoch =
+            __atomic_load_n(&slots_[i].epoch, __ATOMIC_SEQ_CST);
+
+        if (epoch != 0 && epoch < oldest)
+        {
+            oldest = epoch;
+        }
+    }
+
+    std::vector<Retired> kept;
+
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        if (retired_[i].epoch <= oldest)
+        {
+            for (size_t j = 0; j < retired_[i].entries.size(); j++)
+            {
+                delete retired_[i].entries[j];
+            }
+            delete retired_[i].table;
+        }
+        else
+        {
+            kept.push_back(retired_[i]);
+        }
+    }
+
+    retired_.swap(kept);
+}
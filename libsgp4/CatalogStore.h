@@ -0,0 +1,267 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CATALOGSTORE_H_
+#define CATALOGSTORE_H_
+
+#include "SGP4.h"
+#include "SatelliteCatalog.h"
+#include "DateTime.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <pthread.h>
+
+/**
+ * @brief A catalog of models indexed by norad number, which can be updated
+ * while it is being read.
+ *
+ * Readers take a Snapshot, which sees the catalog as it was when the
+ * snapshot was taken for as long as the snapshot lives. Looking satellites
+ * up never blocks and never sees a model which is still being initialised.
+ * Taking a snapshot does not wait for updates either, only for a free
+ * slot when kSnapshots snapshots are already held, yielding the processor
+ * until one is released.
+ *
+ * Updates build a new index with new, fully initialised, models and
+ * publish it with a single atomic store. What it replaces is kept until
+ * every snapshot which could still see it has been released, and is
+ * freed by a later update. This is read-copy-update with epochs: each
+ * snapshot records the epoch it started in, and each update advances the
+ * epoch. Updates are serialised with each other by a mutex.
+ *
+ * Models in the catalog are shared by every reader, so entries only
+ * propagate them with an SGP4::Context supplied by the reader.
+ */
+class CatalogStore
+{
+public:
+    /**
+     * @brief One satellite in the catalog. Entries never change once
+     * published.
+     */
+    class Entry
+    {
+    public:
+        /**
+         * @param[in] model the model of the newest elements
+         * @param[in] epochs the epochs of the element sets published
+         */
+        Entry(const SGP4& model, const std::vector<DateTime>& epochs)
+            : model_(model),
+            epochs_(epochs)
+        {
+        }
+
+        /**
+         * @returns the newest elements
+         */
+        const OrbitalElements& Elements() const
+        {
+            return model_.Elements();
+        }
+
+        /**
+         * Propagate the newest elements, as SGP4::FindPosition() does with
+         * a context.
+         * @param[in] tsince time since epoch in minutes
+         * @param[in,out] context the reader's integrator state
+         * @returns the position and velocity
+         * @exception SatelliteException
+         * @exception DecayedException
+         */
+        Eci FindPosition(double tsince, SGP4::Context& context) const
+        {
+            return model_.FindPosition(tsince, context);
+        }
+
+        /**
+         * @param[in] date the time to propagate to
+         * @param[in,out] context the reader's integrator state
+         * @returns the position and velocity
+         * @exception SatelliteException
+         * @exception DecayedException
+         */
+        Eci FindPosition(
+                const DateTime& date,
+                SGP4::Context& context) const
+        {
+            return model_.FindPosition(date, context);
+        }
+
+        /**
+         * Non throwing version of FindPosition(), as
+         * SGP4::TryFindPosition().
+         * @param[in] tsince time since epoch in minutes
+         * @param[in,out] context the reader's integrator state
+         * @param[out] eci the position and velocity
+         * @returns the propagation result
+         */
+        SGP4::Status TryFindPosition(
+                double tsince,
+                SGP4::Context& context,
+                Eci& eci) const
+        {
+            return model_.TryFindPosition(tsince, context, eci);
+        }
+
+        /**
+         * @returns the epochs of the last kEpochs element sets published,
+         * oldest first
+         */
+        const std::vector<DateTime>& Epochs() const
+        {
+            return epochs_;
+        }
+
+    private:
+        /*
+         * the model is only reached through the methods taking a context,
+         * as its own context would be shared by every reader
+         */
+        const SGP4 model_;
+        const std::vector<DateTime> epochs_;
+    };
+
+private:
+    /*
+     * the entries in increasing norad number, which never change once
+     * published
+     */
+    struct Table
+    {
+        std::vector<unsigned int> norad_numbers;
+        std::vector<const Entry*> entries;
+    };
+
+public:
+
+    /**
+     * @brief A consistent view of the catalog for one reader.
+     *
+     * Entries found through a snapshot stay valid until it is destroyed.
+     * At most kSnapshots snapshots may be held at once, more wait for one
+     * to be released. A snapshot should be used by one thread at a time.
+     */
+    class Snapshot
+    {
+    public:
+        /**
+         * @param[in] store the catalog to view
+         */
+        Snapshot(const CatalogStore& store);
+
+        ~Snapshot();
+
+        /**
+         * @param[in] norad_number the satellite
+         * @returns the satellite, or NULL if it is not in the catalog
+         */
+        const Entry* Find(const unsigned int norad_number) const;
+
+        /**
+         * @returns the number of satellites
+         */
+        size_t Size() const;
+
+        /**
+         * @param[in] i the satellite, below Size()
+         * @returns the satellite, in increasing norad number
+         */
+        const Entry& operator[](const size_t i) const;
+
+    private:
+        Snapshot(const Snapshot&);
+        Snapshot& operator=(const Snapshot&);
+
+        const CatalogStore& store_;
+        size_t slot_;
+        const Table* table_;
+    };
+
+    /**
+     * The number of snapshots which may be held at once.
+     */
+    static const size_t kSnapshots = 64;
+
+    /**
+     * The number of epochs each entry remembers, so that updating a
+     * satellite copies a bounded history.
+     */
+    static const size_t kEpochs = 16;
+
+    CatalogStore();
+
+    /**
+     * No snapshot may be held while the store is destroyed.
+     */
+    virtual ~CatalogStore();
+
+    /**
+     * Publish the models of a catalog, replacing any older elements of the
+     * same satellites. Models with an epoch no newer than the one
+     * published already are ignored.
+     * @param[in] catalog the new models
+     * @returns the number of models published
+     */
+    size_t Update(const SatelliteCatalog& catalog);
+
+    /**
+     * Publish the model of one satellite.
+     * @param[in] tle the new elements
+     * @returns whether the model was published
+     * @exception SatelliteException if the satellite fails to initialise
+     */
+    bool Update(const Tle& tle);
+
+private:
+    CatalogStore(const CatalogStore&);
+    CatalogStore& operator=(const CatalogStore&);
+
+    /*
+     * what an update replaced, and the epoch from which no new snapshot
+     * can see it
+     */
+    struct Retired
+    {
+        unsigned long long epoch;
+        const Table* table;
+        std::vector<const Entry*> entries;
+    };
+
+    /*
+     * the epoch a snapshot started in, zero if the slot is free, alone on
+     * a cache line so that readers do not contend
+     */
+    struct Slot
+    {
+        unsigned long long epoch;
+        char padding[64 - sizeof(unsigned long long)];
+    };
+
+    size_t Publish(const std::vector<const SGP4*>& models);
+    void Reclaim();
+
+    const Table* table_;
+    unsigned long long epoch_;
+    mutable Slot slots_[kSnapshots];
+    std::vector<Retired> retired_;
+    pthread_mutex_t mutex_;
+};
+
+#endif
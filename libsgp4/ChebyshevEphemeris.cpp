@@ -0,0 +1,305 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ChebyshevEphemeris.h"
+
+#include "Globals.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * length of the first segment tried, in minutes
+     */
+    const double kInitialSegment = 60.0;
+
+    /*
+     * segments are accepted at this length whatever their error, in minutes
+     */
+    const double kMinimumSegment = 1.0e-3;
+
+    /*
+     * the number of intervals the error is checked at between each pair of
+     * extrema
+     */
+    const size_t kChecks = 8;
+}
+
+ChebyshevEphemeris::ChebyshevEphemeris(
+        const SGP4& model,
+        const DateTime& start,
+        const DateTime& end,
+        const double tolerance,
+        const unsigned int degree)
+    : start_(start),
+    end_(end),
+    tolerance_(tolerance),
+    degree_(degree)
+{
+    if (end_ <= start_)
+    {
+        throw std::invalid_argument("Ephemeris must end after it starts");
+    }
+    if (tolerance_ <= 0.0)
+    {
+        throw std::invalid_argument("Ephemeris tolerance must be positive");
+    }
+    if (degree_ < 1)
+    {
+        throw std::invalid_argument("Ephemeris degree must be at least one");
+    }
+
+    const double span = static_cast<double>((end_ - start_).Ticks())
+        / TicksPerMinute;
+    const double order = static_cast<double>(degree_ + 1);
+    std::vector<double> segment(kComponents * (degree_ + 1));
+    double begin = 0.0;
+    double length = std::min(kInitialSegment, span);
+
+    breaks_.push_back(0.0);
+
+    while (begin < span)
+    {
+        const bool last = length >= span - begin;
+        if (last)
+        {
+            length = span - begin;
+        }
+
+        const double error = Fit(model, begin, length, &segment[0]);
+
+        if (error <= tolerance_ || length <= kMinimumSegment)
+        {
+            coefficients_.insert(coefficients_.end(),
+                    segment.begin(),
+                    segment.end());
+            begin = last ? span : begin + length;
+            breaks_.push_back(begin);
+        }
+
+        /*
+         * the error goes as the length to the power of the order, so choose
+         * the next length as a step size controller would, allowing it to
+         * halve or double at most
+         */
+        double scale = 2.0;
+        if (error > 0.0)
+        {
+            scale = 0.9 * pow(tolerance_ / error, 1.0 / order);
+            scale = std::max(0.5, std::min(2.0, scale));
+        }
+        length = std::max(kMinimumSegment, length * scale);
+    }
+}
+
+/*
+ * fit one segment, returning the largest position error found. the error is
+ * checked at the extrema of the next chebyshev polynomial, where it usually
+ * peaks, and at kChecks - 1 points spaced evenly in angle between each pair
+ * of them, so that a peak away from the extrema is not missed
+ */
+double ChebyshevEphemeris::Fit(
+        const SGP4& model,
+        const double begin,
+        const double length,
+        double* coefficients) const
+{
+    const size_t n = degree_ + 1;
+    const double order = static_cast<double>(n);
+    const double half = 0.5 * length;
+    const double middle = begin + half;
+    std::vector<double> values(kComponents * n);
+
+    for (size_t j = 0; j < n; j++)
+    {
+        const double u = cos(kPI * (static_cast<double>(j) + 0.5) / order);
+        const Eci eci = model.FindPosition(
+                start_.AddMinutes(middle + half * u));
+        const Vector position = eci.Position();
+        const Vector velocity = eci.Velocity();
+
+        values[j] = position.x;
+        values[n + j] = position.y;
+        values[2 * n + j] = position.z;
+        values[3 * n + j] = velocity.x;
+        values[4 * n + j] = velocity.y;
+        values[5 * n + j] = velocity.z;
+    }
+
+    for (size_t c = 0; c < kComponents; c++)
+    {
+        const double* value = &values[c * n];
+        double* coefficient = &coefficients[c * n];
+
+        for (size_t k = 0; k < n; k++)
+        {
+            double sum = 0.0;
+            for (size_t j = 0; j < n; j++)
+            {
+                sum += value[j] * cos(kPI * static_cast<double>(k)
+                        * (static_cast<double>(j) + 0.5) / order);
+            }
+            coefficient[k] = 2.0 * sum / order;
+        }
+
+        /*
+         * store half the first coefficient, so that evaluation is a plain sum
+         */
+        coefficient[0] *= 0.5;
+    }
+
+    double error = 0.0;
+    const double checks = static_cast<double>(kChecks);
+
+    for (size_t j = 0; j <= kChecks * n; j++)
+    {
+        const double u = cos(kPI * static_cast<double>(j) / (checks * order));
+        const Eci eci = model.FindPosition(
+                start_.AddMinutes(middle + half * u));
+        double fit[3];
+        Evaluate<false>(coefficients, u, fit);
+
+        error = std::max(error,
+                (eci.Position() - Vector(fit[0], fit[1], fit[2])).Magnitude());
+    }
+
+    return error;
+}
+
+/*
+ * find the segment containing ticks since start_, returning its coefficients
+ * and setting u to the position within it in [-1, 1]
+ */
+const double* ChebyshevEphemeris::Locate(
+        const long long ticks,
+        double& u) const
+{
+    const double minutes = static_cast<double>(ticks) / TicksPerMinute;
+
+    if (minutes < 0.0 || minutes > breaks_.back())
+    {
+        throw std::out_of_range("Time is outside of the ephemeris span");
+    }
+
+    size_t segment = static_cast<size_t>(
+            std::upper_bound(breaks_.begin(), breaks_.end(), minutes)
+            - breaks_.begin());
+    segment = std::min(segment, breaks_.size() - 1) - 1;
+
+    const double begin = breaks_[segment];
+    const double end = breaks_[segment + 1];
+
+    u = (2.0 * minutes - begin - end) / (end - begin);
+
+    return &coefficients_[segment * kComponents * (degree_ + 1)];
+}
+
+/*
+ * clenshaw's recurrence for the position, and the velocity if VELOCITY, run
+ * side by side so that the components do not wait on each other
+ */
+template <bool VELOCITY>
+void ChebyshevEphemeris::Evaluate(
+        const double* coefficients,
+        const double u,
+        double* result) const
+{
+    const size_t count = VELOCITY ? kComponents : 3;
+    const size_t n = degree_ + 1;
+    const double u2 = 2.0 * u;
+    double b1[kComponents] = { 0.0 };
+    double b2[kComponents] = { 0.0 };
+
+    for (size_t k = degree_; k > 0; k--)
+    {
+        for (size_t c = 0; c < count; c++)
+        {
+            const double b0 = u2 * b1[c] - b2[c] + coefficients[c * n + k];
+            b2[c] = b1[c];
+            b1[c] = b0;
+        }
+    }
+
+    for (size_t c = 0; c < count; c++)
+    {
+        result[c] = u * b1[c] - b2[c] + coefficients[c * n];
+    }
+}
+
+Eci ChebyshevEphemeris::FindPosition(const DateTime& date) const
+{
+    double u;
+    const double* coefficients = Locate((date - start_).Ticks(), u);
+    double result[kComponents];
+
+    Evaluate<true>(coefficients, u, result);
+
+    return Eci(date,
+            Vector(result[0], result[1], result[2]),
+            Vector(result[3], result[4], result[5]));
+}
+
+void ChebyshevEphemeris::FindPositions(
+        const DateTime& start,
+        const TimeSpan& step,
+        const size_t n,
+        double* x,
+        double* y,
+        double* z,
+        double* vx,
+        double* vy,
+        double* vz) const
+{
+    /*
+     * work in ticks relative to the start of the span so that the times do
+     * not accumulate rounding errors over long ranges
+     */
+    const long long offset = (start - start_).Ticks();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const long long ticks = offset
+            + static_cast<long long>(i) * step.Ticks();
+        double u;
+        const double* coefficients = Locate(ticks, u);
+        double result[kComponents];
+
+        if (vx == NULL)
+        {
+            Evaluate<false>(coefficients, u, result);
+        }
+        else
+        {
+            Evaluate<true>(coefficients, u, result);
+        }
+
+        x[i] = result[0];
+        y[i] = result[1];
+        z[i] = result[2];
+
+        if (vx != NULL)
+        {
+            vx[i] = result[3];
+            vy[i] = result[4];
+            vz[i] = result[5];
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CHEBYSHEVEPHEMERIS_H_
+#define CHEBYSHEVEPHEMERIS_H_
+
+#include "SGP4.h"
+#include "Eci.h"
+#include "DateTime.h"
+#include "TimeSpan.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Piecewise Chebyshev fit of a satellite over a span of time.
+ *
+ * The span is split into segments and on each segment the position and
+ * velocity are fitted by Chebyshev polynomials of a fixed degree,
+ * interpolating SGP4 at the Chebyshev nodes. Segments are split until the
+ * position differs from SGP4 by no more than the tolerance at the points
+ * between nodes, where the error of the fit is usually largest, and at
+ * seven more points between each pair of those. Evaluating the fit costs a
+ * search for the segment and one Clenshaw recurrence per component.
+ *
+ * The error is still only checked at points, so a feature of SGP4 narrower
+ * than the spacing of the checks, such as near decay, could be missed. The
+ * benchmark program reports the worst error found between the checks.
+ */
+class ChebyshevEphemeris
+{
+public:
+    /**
+     * Fit the satellite between start and end.
+     * @param[in] model the satellite
+     * @param[in] start the start of the span
+     * @param[in] end the end of the span
+     * @param[in] tolerance the maximum position error in km
+     * @param[in] degree the degree of the polynomials
+     * @exception std::invalid_argument if the span is empty, the tolerance
+     * is not positive or the degree is zero
+     * @exception SatelliteException
+     * @exception DecayedException
+     */
+    ChebyshevEphemeris(
+            const SGP4& model,
+            const DateTime& start,
+            const DateTime& end,
+            const double tolerance = 1.0e-3,
+            const unsigned int degree = 12);
+
+    virtual ~ChebyshevEphemeris()
+    {
+    }
+
+    /**
+     * @returns the start of the span
+     */
+    DateTime Start() const
+    {
+        return start_;
+    }
+
+    /**
+     * @returns the end of the span
+     */
+    DateTime End() const
+    {
+        return end_;
+    }
+
+    /**
+     * @returns the degree of the polynomials
+     */
+    unsigned int Degree() const
+    {
+        return degree_;
+    }
+
+    /**
+     * @returns the number of segments
+     */
+    size_t Segments() const
+    {
+        return breaks_.size() - 1;
+    }
+
+    /**
+     * @returns the memory used by the fit in bytes
+     */
+    size_t Bytes() const
+    {
+        return sizeof(*this)
+            + breaks_.capacity() * sizeof(double)
+            + coefficients_.capacity() * sizeof(double);
+    }
+
+    /**
+     * @param[in] date the time, which must be within the span
+     * @returns the fitted position and velocity
+     * @exception std::out_of_range if date is outside of the span
+     */
+    Eci FindPosition(const DateTime& date) const;
+
+    /**
+     * Evaluate the fit at n evenly spaced times starting at start, writing
+     * the results into caller owned structure-of-arrays buffers. Each
+     * buffer must hold n values.
+     * @param[in] start the first time
+     * @param[in] step the interval between times
+     * @param[in] n the number of times
+     * @param[out] x position x in km
+     * @param[out] y position y in km
+     * @param[out] z position z in km
+     * @param[out] vx velocity x in km/s
+     * @param[out] vy velocity y in km/s
+     * @param[out] vz velocity z in km/s
+     *
+     * If vx, vy and vz are NULL only the positions are calculated.
+     * @exception std::out_of_range if a time is outside of the span
+     */
+    void FindPositions(
+            const DateTime& start,
+            const TimeSpan& step,
+            const size_t n,
+            double* x,
+            double* y,
+            double* z,
+            double* vx,
+            double* vy,
+            double* vz) const;
+
+private:
+    /*
+     * position x, y, z and velocity x, y, z
+     */
+    static const size_t kComponents = 6;
+
+    double Fit(
+            const SGP4& model,
+            const double begin,
+            const double length,
+            double* coefficients) const;
+    const double* Locate(const long long ticks, double& u) const;
+    template <bool VELOCITY>
+    void Evaluate(
+            const double* coefficients,
+            const double u,
+            double* result) const;
+
+    DateTime start_;
+    DateTime end_;
+    double tolerance_;
+    unsigned int degree_;
+
+    /*
+     * start of each segment in minutes since start_, followed by the end of
+     * the last segment
+     */
+    std::vector<double> breaks_;
+
+    /*
+     * degree_ + 1 coefficients for each component of each segment
+     */
+    std::vector<double> coefficients_;
+};
+
+#endif
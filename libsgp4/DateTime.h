@@ -594,8 +594,18 @@ public:
      */
     double ToJulian() const
     {
-        TimeSpan ts = TimeSpan(Ticks());
-        return ts.TotalDays() + 1721425.5;
+        return Julian(Ticks());
+    }
+
+    /**
+     * Julian date of a number of ticks, for callers which work in ticks
+     * without a DateTime for each time
+     * @param[in] ticks raw tick value
+     * @returns the julian date
+     */
+    static double Julian(const long long ticks)
+    {
+        return TimeSpan(ticks).TotalDays() + 1721425.5;
     }
 
     /**
@@ -603,9 +613,20 @@ public:
      * @returns the greenwich sidereal time
      */
     double ToGreenwichSiderealTime() const
+    {
+        return GreenwichSiderealTime(ToJulian());
+    }
+
+    /**
+     * Greenwich sidereal time of a julian date, for callers which already
+     * have the julian date
+     * @param[in] julian the julian date
+     * @returns the greenwich sidereal time
+     */
+    static double GreenwichSiderealTime(const double julian)
     {
         // t = Julian centuries from 2000 Jan. 1 12h UT1
-        const double t = (ToJulian() - 2451545.0) / 36525.0;
+        const double t = (julian - 2451545.0) / 36525.0;
 
         // Rotation angle in arcseconds
         double theta = 67310.54841
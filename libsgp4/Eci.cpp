@@ -23,9 +23,13 @@
 /**
  * Converts a DateTime and Geodetic position to Eci coordinates
  * @param[in] dt the date
+ * @param[in] gmst the greenwich sidereal time of the date
  * @param[in] geo the geodetic position
  */
-void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
+void Eci::ToEci(
+        const DateTime& dt,
+        const double gmst,
+        const CoordGeodetic &geo)
 {
     /*
      * set date
@@ -37,15 +41,22 @@ void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
     /*
      * Calculate Local Mean Sidereal Time for observers longitude
      */
-    const double theta = m_dt.ToLocalMeanSiderealTime(geo.longitude);
+    const double theta = Util::WrapTwoPI(gmst + geo.longitude);
+
+    double sin_lat;
+    double cos_lat;
+    double sin_theta;
+    double cos_theta;
+    Util::SinCos(geo.latitude, sin_lat, cos_lat);
+    Util::SinCos(theta, sin_theta, cos_theta);
 
     /*
      * take into account earth flattening
      */
     const double c = 1.0
-        / sqrt(1.0 + kF * (kF - 2.0) * pow(sin(geo.latitude), 2.0));
-    const double s = pow(1.0 - kF, 2.0) * c;
-    const double achcp = (kXKMPER * c + geo.altitude) * cos(geo.latitude);
+        / sqrt(1.0 + kF * (kF - 2.0) * sin_lat * sin_lat);
+    const double s = (1.0 - kF) * (1.0 - kF) * c;
+    const double achcp = (kXKMPER * c + geo.altitude) * cos_lat;
 
     /*
      * X position in km
@@ -53,9 +64,9 @@ void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
      * Z position in km
      * W magnitude in km
      */
-    m_position.x = achcp * cos(theta);
-    m_position.y = achcp * sin(theta);
-    m_position.z = (kXKMPER * s + geo.altitude) * sin(geo.latitude);
+    m_position.x = achcp * cos_theta;
+    m_position.y = achcp * sin_theta;
+    m_position.z = (kXKMPER * s + geo.altitude) * sin_lat;
     m_position.w = m_position.Magnitude();
 
     /*
@@ -74,11 +85,15 @@ void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
  * @returns the position in geodetic form
  */
 CoordGeodetic Eci::ToGeodetic() const
+{
+    return ToGeodetic(m_dt.ToGreenwichSiderealTime());
+}
+
+CoordGeodetic Eci::ToGeodetic(const double gmst) const
 {
     const double theta = Util::AcTan(m_position.y, m_position.x);
 
-    const double lon = Util::WrapNegPosPI(theta
-            - m_dt.ToGreenwichSiderealTime());
+    const double lon = Util::WrapNegPosPI(theta - gmst);
 
     const double r = sqrt((m_position.x * m_position.x)
             + (m_position.y * m_position.y));
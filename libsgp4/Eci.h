@@ -21,6 +21,7 @@
 #include "CoordGeodetic.h"
 #include "Vector.h"
 #include "DateTime.h"
+#include "TimeContext.h"
 
 /**
  * @brief Stores an Earth-centered inertial position for a particular time.
@@ -40,7 +41,8 @@ public:
             const double longitude,
             const double altitude)
     {
-        ToEci(dt, CoordGeodetic(latitude, longitude, altitude));
+        ToEci(dt, dt.ToGreenwichSiderealTime(),
+                CoordGeodetic(latitude, longitude, altitude));
     }
 
     /**
@@ -49,7 +51,16 @@ public:
      */
     Eci(const DateTime& dt, const CoordGeodetic& geo)
     {
-        ToEci(dt, geo);
+        ToEci(dt, dt.ToGreenwichSiderealTime(), geo);
+    }
+
+    /**
+     * @param[in] time the time to be used for this position
+     * @param[in] geo the position
+     */
+    Eci(const TimeContext& time, const CoordGeodetic& geo)
+    {
+        ToEci(time.GetDateTime(), time.Gmst(), geo);
     }
 
     /**
@@ -108,7 +119,32 @@ public:
      */
     void Update(const DateTime& dt, const CoordGeodetic& geo)
     {
-        ToEci(dt, geo);
+        ToEci(dt, dt.ToGreenwichSiderealTime(), geo);
+    }
+
+    /**
+     * Update this object with a new time and geodetic position
+     * @param time new time
+     * @param geo new geodetic position
+     */
+    void Update(const TimeContext& time, const CoordGeodetic& geo)
+    {
+        ToEci(time.GetDateTime(), time.Gmst(), geo);
+    }
+
+    /**
+     * Update this object with the sidereal time already known, such as
+     * from TimeGrid::SiderealTimes()
+     * @param dt new date
+     * @param gmst the greenwich mean sidereal time of dt
+     * @param geo new geodetic position
+     */
+    void Update(
+            const DateTime& dt,
+            const double gmst,
+            const CoordGeodetic& geo)
+    {
+        ToEci(dt, gmst, geo);
     }
 
     /**
@@ -140,8 +176,29 @@ public:
      */
     CoordGeodetic ToGeodetic() const;
 
+    /**
+     * Convert to geodetic form with the sidereal time already known, such
+     * as when it is kept up to date by a caller stepping through time.
+     * @param[in] gmst the greenwich mean sidereal time of the date
+     * @returns the position in geodetic form
+     */
+    CoordGeodetic ToGeodetic(const double gmst) const;
+
+    /**
+     * Convert to geodetic form using the sidereal time of a context.
+     * @param[in] time the context for the date of this position
+     * @returns the position in geodetic form
+     */
+    CoordGeodetic ToGeodetic(const TimeContext& time) const
+    {
+        return ToGeodetic(time.Gmst());
+    }
+
 private:
-    void ToEci(const DateTime& dt, const CoordGeodetic& geo);
+    void ToEci(
+            const DateTime& dt,
+            const double gmst,
+            const CoordGeodetic& geo);
 
     DateTime m_dt;
     Vector m_position;
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef EPHEMERISFILE_H_
+#define EPHEMERISFILE_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Layout of the binary ephemeris file.
+ *
+ * The file is a Header, then the records of each satellite, then an Index
+ * entry for each satellite sorted by norad number. Every satellite has one
+ * Record per sample, at start + i * step for i below samples. Values are
+ * stored in the byte order of the machine that wrote the file.
+ */
+namespace EphemerisFile
+{
+    const char kMagic[8] = { 'S', 'G', 'P', '4', 'E', 'P', 'H', '\0' };
+    const uint32_t kVersion = 1;
+    /**
+     * the offsets of the index and of every satellite's records are
+     * multiples of this, the alignment of the structures below
+     */
+    const uint64_t kAlignment = 8;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        /** size of a Record in bytes */
+        uint32_t record_size;
+        /** ticks of the first sample */
+        int64_t start;
+        /** ticks between samples */
+        int64_t step;
+        /** number of samples per satellite */
+        uint64_t samples;
+        /** number of satellites */
+        uint64_t satellites;
+        /** offset of the index from the start of the file */
+        uint64_t index_offset;
+        uint64_t reserved;
+    };
+
+    struct Index
+    {
+        uint32_t norad_number;
+        uint32_t reserved;
+        /** offset of the first record from the start of the file */
+        uint64_t offset;
+    };
+
+    struct Record
+    {
+        /** position in km */
+        double x;
+        double y;
+        double z;
+        /** velocity in km/s */
+        double vx;
+        double vy;
+        double vz;
+        /** SGP4::Status of the sample */
+        int32_t status;
+        uint32_t reserved;
+    };
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "EphemerisReader.h"
+
+#include "SGP4.h"
+#include "Util.h"
+#include "Vector.h"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+EphemerisReader::EphemerisReader(const std::string& filename)
+    : map_(MAP_FAILED),
+    size_(0),
+    header_(NULL),
+    index_(NULL)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw EphemerisException("Error opening ephemeris file");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw EphemerisException("Error reading ephemeris file size");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ < sizeof(EphemerisFile::Header))
+    {
+        close(fd);
+        throw EphemerisException("Ephemeris file is too short");
+    }
+
+    map_ = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map_ == MAP_FAILED)
+    {
+        throw EphemerisException("Error mapping ephemeris file");
+    }
+
+    const char* base = static_cast<const char*>(map_);
+    header_ = reinterpret_cast<const EphemerisFile::Header*>(base);
+
+    const char* error = NULL;
+    if (memcmp(header_->magic, EphemerisFile::kMagic,
+                sizeof(header_->magic)) != 0)
+    {
+        error = "Not an ephemeris file";
+    }
+    else if (header_->version != EphemerisFile::kVersion)
+    {
+        error = "Unsupported ephemeris file version";
+    }
+    else if (header_->record_size != sizeof(EphemerisFile::Record)
+            || header_->samples < 2
+            || header_->step <= 0
+            || header_->start < 0
+            || header_->start > MaxValueTicks)
+    {
+        error = "Invalid ephemeris header";
+    }
+    else if (header_->samples - 1 > static_cast<uint64_t>(
+                (MaxValueTicks - header_->start) / header_->step))
+    {
+        /*
+         * so that the time of every sample is a valid date, and finding
+         * the sample for a date cannot overflow
+         */
+        error = "Ephemeris covers too long a span";
+    }
+    else if (header_->index_offset % EphemerisFile::kAlignment != 0)
+    {
+        error = "Ephemeris index is misaligned";
+    }
+    else if (header_->index_offset > size_
+            || header_->satellites > (size_ - header_->index_offset)
+                / sizeof(EphemerisFile::Index))
+    {
+        error = "Ephemeris index is truncated";
+    }
+    else
+    {
+        index_ = reinterpret_cast<const EphemerisFile::Index*>(
+                base + header_->index_offset);
+
+        for (uint64_t i = 0; i < header_->satellites && error == NULL; i++)
+        {
+            /*
+             * divide rather than multiply the number of samples, which
+             * could overflow
+             */
+            if (index_[i].offset % EphemerisFile::kAlignment != 0)
+            {
+                error = "Ephemeris records are misaligned";
+            }
+            else if (index_[i].offset < sizeof(EphemerisFile::Header)
+                    || index_[i].offset > header_->index_offset
+                    || header_->samples > (header_->index_offset
+                        - index_[i].offset) / sizeof(EphemerisFile::Record))
+            {
+                error = "Ephemeris records are truncated";
+            }
+            else if (i > 0
+                    && index_[i].norad_number <= index_[i - 1].norad_number)
+            {
+                error = "Ephemeris index is not sorted";
+            }
+        }
+    }
+
+    if (error != NULL)
+    {
+        munmap(map_, size_);
+        throw EphemerisException(error);
+    }
+}
+
+EphemerisReader::~EphemerisReader()
+{
+    munmap(map_, size_);
+}
+
+const EphemerisFile::Record* EphemerisReader::Records(
+        const unsigned int norad_number) const
+{
+    size_t low = 0;
+    size_t high = Satellites();
+
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+
+        if (index_[middle].norad_number < norad_number)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == Satellites() || index_[low].norad_number != norad_number)
+    {
+        throw EphemerisException("Satellite is not in the ephemeris file");
+    }
+
+    return reinterpret_cast<const EphemerisFile::Record*>(
+            static_cast<const char*>(map_) + index_[low].offset);
+}
+
+Eci EphemerisReader::FindPosition(
+        const unsigned int norad_number,
+        const DateTime& date) const
+{
+    const EphemerisFile::Record* records = Records(norad_number);
+    const long long ticks = date.Ticks() - header_->start;
+    const long long last = static_cast<long long>(header_->samples) - 1;
+
+    if (ticks < 0 || ticks > last * header_->step)
+    {
+        throw EphemerisException("Time is outside of the ephemeris file");
+    }
+
+    /*
+     * the last sample is interpolated from the interval before it
+     */
+    long long sample = ticks / header_->step;
+    if (sample == last)
+    {
+        sample--;
+    }
+
+    const EphemerisFile::Record& a = records[sample];
+    const EphemerisFile::Record& b = records[sample + 1];
+
+    if (a.status != SGP4::STATUS_OK)
+    {
+        throw EphemerisException(
+                SGP4::StatusString(static_cast<SGP4::Status>(a.status)));
+    }
+    if (b.status != SGP4::STATUS_OK)
+    {
+        throw EphemerisException(
+                SGP4::StatusString(static_cast<SGP4::Status>(b.status)));
+    }
+
+    const double h = static_cast<double>(header_->step) / TicksPerSecond;
+    const double s = static_cast<double>(ticks - sample * header_->step)
+        / static_cast<double>(header_->step);
+    Vector position;
+    Vector velocity;
+
+    Util::Hermite(s, h, a.x, a.vx, b.x, b.vx, position.x, velocity.x);
+    Util::Hermite(s, h, a.y, a.vy, b.y, b.vy, position.y, velocity.y);
+    Util::Hermite(s, h, a.z, a.vz, b.z, b.vz, position.z, velocity.z);
+
+    return Eci(date, position, velocity);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef EPHEMERISREADER_H_
+#define EPHEMERISREADER_H_
+
+#include "EphemerisFile.h"
+#include "EphemerisException.h"
+#include "Eci.h"
+#include "DateTime.h"
+#include "TimeSpan.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Reads a binary ephemeris file written by EphemerisWriter.
+ *
+ * The file is mapped into memory read only, so nothing is parsed or copied
+ * and processes reading the same file share its pages. Records are found
+ * by a binary search of the index, and positions between samples by cubic
+ * Hermite interpolation of the neighbouring records.
+ *
+ * A reader is immutable once constructed and may be shared between threads.
+ */
+class EphemerisReader
+{
+public:
+    /**
+     * Map a file and check its header and index.
+     * @param[in] filename the file to read
+     * @exception EphemerisException if the file cannot be mapped or is not
+     * a valid ephemeris file
+     */
+    EphemerisReader(const std::string& filename);
+
+    virtual ~EphemerisReader();
+
+    /**
+     * @returns the time of the first sample
+     */
+    DateTime Start() const
+    {
+        return DateTime(static_cast<unsigned long long>(header_->start));
+    }
+
+    /**
+     * @returns the interval between samples
+     */
+    TimeSpan Step() const
+    {
+        return TimeSpan(header_->step);
+    }
+
+    /**
+     * @returns the number of samples per satellite
+     */
+    size_t Samples() const
+    {
+        return static_cast<size_t>(header_->samples);
+    }
+
+    /**
+     * @returns the number of satellites
+     */
+    size_t Satellites() const
+    {
+        return static_cast<size_t>(header_->satellites);
+    }
+
+    /**
+     * @param[in] i the satellite, below Satellites()
+     * @returns the norad number of the satellite, in increasing order
+     */
+    unsigned int NoradNumber(const size_t i) const
+    {
+        return index_[i].norad_number;
+    }
+
+    /**
+     * @param[in] norad_number the satellite
+     * @returns the Samples() records of the satellite, which stay valid for
+     * the life of the reader
+     * @exception EphemerisException if the satellite is not in the file
+     */
+    const EphemerisFile::Record* Records(
+            const unsigned int norad_number) const;
+
+    /**
+     * @param[in] norad_number the satellite
+     * @param[in] date the time, between the first and last samples
+     * @returns the position and velocity
+     * @exception EphemerisException if the satellite is not in the file,
+     * the time is outside of the file or the satellite failed to propagate
+     * at a neighbouring sample
+     */
+    Eci FindPosition(
+            const unsigned int norad_number,
+            const DateTime& date) const;
+
+private:
+    EphemerisReader(const EphemerisReader&);
+    EphemerisReader& operator=(const EphemerisReader&);
+
+    void* map_;
+    size_t size_;
+    const EphemerisFile::Header* header_;
+    const EphemerisFile::Index* index_;
+};
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "EphemerisWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    bool IndexLess(
+            const EphemerisFile::Index& a,
+            const EphemerisFile::Index& b)
+    {
+        return a.norad_number < b.norad_number;
+    }
+}
+
+EphemerisWriter::EphemerisWriter(
+        const std::string& filename,
+        const DateTime& start,
+        const TimeSpan& step,
+        const size_t samples)
+    : start_(start),
+    step_(step),
+    samples_(samples),
+    offset_(sizeof(EphemerisFile::Header)),
+    records_(samples),
+    x_(samples),
+    y_(samples),
+    z_(samples),
+    vx_(samples),
+    vy_(samples),
+    vz_(samples),
+    status_(samples)
+{
+    if (samples_ < 2)
+    {
+        throw EphemerisException("Ephemeris needs at least two samples");
+    }
+    if (step_.Ticks() <= 0)
+    {
+        throw EphemerisException("Ephemeris step must be positive");
+    }
+
+    file_.open(filename.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file_.is_open())
+    {
+        throw EphemerisException("Error creating ephemeris file");
+    }
+
+    /*
+     * reserve space for the header, which is written by Close()
+     */
+    const EphemerisFile::Header header = EphemerisFile::Header();
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    Check("Error writing ephemeris header");
+}
+
+EphemerisWriter::~EphemerisWriter()
+{
+    if (file_.is_open())
+    {
+        try
+        {
+            Close();
+        }
+        catch (EphemerisException&)
+        {
+        }
+    }
+}
+
+void EphemerisWriter::Write(const unsigned int norad_number, const SGP4& model)
+{
+    model.FindPositions(start_, step_, samples_,
+            &x_[0], &y_[0], &z_[0], &vx_[0], &vy_[0], &vz_[0], &status_[0]);
+    Write(norad_number,
+            &x_[0], &y_[0], &z_[0], &vx_[0], &vy_[0], &vz_[0], &status_[0]);
+}
+
+void EphemerisWriter::Write(
+        const unsigned int norad_number,
+        const double* x,
+        const double* y,
+        const double* z,
+        const double* vx,
+        const double* vy,
+        const double* vz,
+        const SGP4::Status* status)
+{
+    if (written_.find(norad_number) != written_.end())
+    {
+        throw EphemerisException("Satellite already written");
+    }
+
+    for (size_t i = 0; i < samples_; i++)
+    {
+        EphemerisFile::Record& record = records_[i];
+        record.x = x[i];
+        record.y = y[i];
+        record.z = z[i];
+        record.vx = vx[i];
+        record.vy = vy[i];
+        record.vz = vz[i];
+        record.status = static_cast<int32_t>(status[i]);
+        record.reserved = 0;
+    }
+
+    file_.write(reinterpret_cast<const char*>(&records_[0]),
+            static_cast<std::streamsize>(
+                samples_ * sizeof(EphemerisFile::Record)));
+    Check("Error writing ephemeris records");
+
+    EphemerisFile::Index entry = EphemerisFile::Index();
+    entry.norad_number = norad_number;
+    entry.offset = offset_;
+    index_.push_back(entry);
+    written_.insert(norad_number);
+
+    offset_ += samples_ * sizeof(EphemerisFile::Record);
+}
+
+void EphemerisWriter::Close()
+{
+    std::sort(index_.begin(), index_.end(), IndexLess);
+
+    if (!index_.empty())
+    {
+        file_.write(reinterpret_cast<const char*>(&index_[0]),
+                static_cast<std::streamsize>(
+                    index_.size() * sizeof(EphemerisFile::Index)));
+        Check("Error writing ephemeris index");
+    }
+
+    EphemerisFile::Header header = EphemerisFile::Header();
+    memcpy(header.magic, EphemerisFile::kMagic, sizeof(header.magic));
+    header.version = EphemerisFile::kVersion;
+    header.record_size = sizeof(EphemerisFile::Record);
+    header.start = start_.Ticks();
+    header.step = step_.Ticks();
+    header.samples = samples_;
+    header.satellites = index_.size();
+    header.index_offset = offset_;
+
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    Check("Error writing ephemeris header");
+
+    file_.close();
+    Check("Error closing ephemeris file");
+}
+
+void EphemerisWriter::Check(const char* message)
+{
+    if (!file_.good())
+    {
+        file_.close();
+        throw EphemerisException(message);
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef EPHEMERISWRITER_H_
+#define EPHEMERISWRITER_H_
+
+#include "EphemerisFile.h"
+#include "EphemerisException.h"
+#include "SGP4.h"
+#include "DateTime.h"
+#include "TimeSpan.h"
+
+#include <cstddef>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Writes a binary ephemeris file.
+ *
+ * Each satellite is propagated to every sample time and its records are
+ * appended to the file. The index and header are written by Close().
+ * The file can then be read with EphemerisReader.
+ */
+class EphemerisWriter
+{
+public:
+    /**
+     * @param[in] filename the file to create
+     * @param[in] start the time of the first sample
+     * @param[in] step the interval between samples
+     * @param[in] samples the number of samples per satellite, at least two
+     * @exception EphemerisException if the file cannot be created
+     */
+    EphemerisWriter(
+            const std::string& filename,
+            const DateTime& start,
+            const TimeSpan& step,
+            const size_t samples);
+
+    /**
+     * Closes the file if Close() has not been called, ignoring any error.
+     */
+    virtual ~EphemerisWriter();
+
+    /**
+     * Propagate a satellite and append its records. Samples where the
+     * propagation fails are written with their status.
+     * @param[in] norad_number the satellite
+     * @param[in] model the satellite
+     * @exception EphemerisException if the satellite was already written or
+     * the records cannot be written
+     */
+    void Write(const unsigned int norad_number, const SGP4& model);
+
+    /**
+     * Append the records of a satellite propagated elsewhere. Each buffer
+     * must hold Samples() values.
+     * @param[in] norad_number the satellite
+     * @param[in] x position x in km
+     * @param[in] y position y in km
+     * @param[in] z position z in km
+     * @param[in] vx velocity x in km/s
+     * @param[in] vy velocity y in km/s
+     * @param[in] vz velocity z in km/s
+     * @param[in] status the result of each sample
+     * @exception EphemerisException if the satellite was already written or
+     * the records cannot be written
+     */
+    void Write(
+            const unsigned int norad_number,
+            const double* x,
+            const double* y,
+            const double* z,
+            const double* vx,
+            const double* vy,
+            const double* vz,
+            const SGP4::Status* status);
+
+    /**
+     * Write the index and header and close the file.
+     * @exception EphemerisException if the file cannot be written
+     */
+    void Close();
+
+    /**
+     * @returns the number of samples per satellite
+     */
+    size_t Samples() const
+    {
+        return samples_;
+    }
+
+private:
+    EphemerisWriter(const EphemerisWriter&);
+    EphemerisWriter& operator=(const EphemerisWriter&);
+
+    void Check(const char* message);
+
+    std::ofstream file_;
+    DateTime start_;
+    TimeSpan step_;
+    size_t samples_;
+    uint64_t offset_;
+    std::vector<EphemerisFile::Index> index_;
+    std::set<unsigned int> written_;
+    std::vector<EphemerisFile::Record> records_;
+
+    /*
+     * propagation buffers for Write()
+     */
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+    std::vector<double> vx_;
+    std::vector<double> vy_;
+    std::vector<double> vz_;
+    std::vector<SGP4::Status> status_;
+};
+
+#endif
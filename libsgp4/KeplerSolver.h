@@ -0,0 +1,350 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef KEPLERSOLVER_H_
+#define KEPLERSOLVER_H_
+
+#include "Util.h"
+
+#include <cstddef>
+#include <cmath>
+
+/**
+ * @brief Solves keplers equation in the form used by SGP4.
+ *
+ * Finds epw such that capu = epw - axn * sin(epw) + ayn * cos(epw), where
+ * axn and ayn are the eccentricity vector. This is the usual equation with
+ * mean anomaly capu - omega and eccentric anomaly epw - omega.
+ *
+ * The first guess is Encke's starter, which is accurate to the cube of the
+ * eccentricity, and it is refined by a fixed number of Danby's fourth order
+ * corrections. The number of corrections depends only on the eccentricity
+ * and is chosen so that the residual is below 1e-12 over the whole range
+ * of mean anomaly, so there are no convergence tests and every solution
+ * in a batch takes the same path. The worst case is a mean anomaly near
+ * zero, where the starter is poorest, and it needs from 2 corrections up
+ * to e = 0.9 to 9 as e approaches 1.
+ *
+ * SGP4 itself keeps its newton-raphson loop, which exits as soon as it
+ * converges and so is faster for the nearly circular orbits of most
+ * satellites. This solver is for the batch paths, where every lane must
+ * take the same number of steps.
+ */
+class KeplerSolver
+{
+public:
+    /**
+     * @param[in] elsq the eccentricity squared
+     * @returns the number of corrections needed for the residual to be
+     * below 1e-12
+     */
+    static int Iterations(const double elsq)
+    {
+        if (elsq <= 0.9 * 0.9)
+        {
+            return 2;
+        }
+        else if (elsq <= 0.99 * 0.99)
+        {
+            return 3;
+        }
+        else if (elsq <= 0.999 * 0.999)
+        {
+            return 4;
+        }
+        else if (elsq <= 0.99998 * 0.99998)
+        {
+            return 5;
+        }
+        else if (elsq <= 0.999999 * 0.999999)
+        {
+            return 6;
+        }
+        else if (elsq <= 0.9999999 * 0.9999999)
+        {
+            return 7;
+        }
+        return 9;
+    }
+
+    /**
+     * Solve using a given number of corrections.
+     * @param[in] iterations the number of corrections
+     * @param[in] capu the mean anomaly plus omega
+     * @param[in] axn eccentricity * cos(omega)
+     * @param[in] ayn eccentricity * sin(omega)
+     * @param[out] sinepw sine of the solution
+     * @param[out] cosepw cosine of the solution
+     * @param[out] ecose axn * cosepw + ayn * sinepw
+     * @param[out] esine axn * sinepw - ayn * cosepw
+     * @returns the solution
+     */
+    template <typename T>
+    static T Solve(
+            const int iterations,
+            const T capu,
+            const T axn,
+            const T ayn,
+            T& sinepw,
+            T& cosepw,
+            T& ecose,
+            T& esine)
+    {
+        return Refine(iterations, capu, axn, ayn, Start(capu, axn, ayn),
+                sinepw, cosepw, ecose, esine);
+    }
+
+    /**
+     * Solve starting from a guess instead of the starter, such as the
+     * solution for a slightly different mean anomaly.
+     * @param[in] iterations the number of corrections
+     * @param[in] capu the mean anomaly plus omega
+     * @param[in] axn eccentricity * cos(omega)
+     * @param[in] ayn eccentricity * sin(omega)
+     * @param[in] epw the guess
+     * @param[out] sinepw sine of the solution
+     * @param[out] cosepw cosine of the solution
+     * @param[out] ecose axn * cosepw + ayn * sinepw
+     * @param[out] esine axn * sinepw - ayn * cosepw
+     * @returns the solution
+     */
+    template <typename T>
+    static T Refine(
+            const int iterations,
+            const T capu,
+            const T axn,
+            const T ayn,
+            T epw,
+            T& sinepw,
+            T& cosepw,
+            T& ecose,
+            T& esine)
+    {
+        for (int i = 0; i < iterations; i++)
+        {
+            epw = Correct(capu, axn, ayn, epw);
+        }
+
+        Finish(axn, ayn, epw, sinepw, cosepw, ecose, esine);
+
+        return epw;
+    }
+
+    /**
+     * Solve using as many corrections as the eccentricity needs.
+     * @returns the solution
+     */
+    template <typename T>
+    static T Solve(
+            const T capu,
+            const T axn,
+            const T ayn,
+            T& sinepw,
+            T& cosepw,
+            T& ecose,
+            T& esine)
+    {
+        return Solve(Iterations(axn * axn + ayn * ayn),
+                capu, axn, ayn, sinepw, cosepw, ecose, esine);
+    }
+
+    /**
+     * Solve n equations, all with the number of corrections needed by the
+     * most eccentric. Each step is applied to every equation before the
+     * next step, so the loops over equations have no branches. As n is
+     * only known at run time, GCC does not vectorise these loops at -O2,
+     * use a Group for that.
+     * @param[in] n the number of equations
+     * @param[in] capu the mean anomaly plus omega
+     * @param[in] axn eccentricity * cos(omega)
+     * @param[in] ayn eccentricity * sin(omega)
+     * @param[out] sinepw sine of the solution
+     * @param[out] cosepw cosine of the solution
+     * @param[out] ecose axn * cosepw + ayn * sinepw
+     * @param[out] esine axn * sinepw - ayn * cosepw
+     */
+    template <typename T>
+    static void Solve(
+            const size_t n,
+            const T* capu,
+            const T* axn,
+            const T* ayn,
+            T* sinepw,
+            T* cosepw,
+            T* ecose,
+            T* esine)
+    {
+        static const size_t kBlock = 64;
+
+        for (size_t begin = 0; begin < n; begin += kBlock)
+        {
+            const size_t end = begin + kBlock < n ? begin + kBlock : n;
+            T epw[kBlock];
+            T elsq = T(0.0);
+
+            for (size_t i = begin; i < end; i++)
+            {
+                const T e2 = axn[i] * axn[i] + ayn[i] * ayn[i];
+                elsq = e2 > elsq ? e2 : elsq;
+            }
+
+            const int iterations = Iterations(elsq);
+
+            for (size_t i = begin; i < end; i++)
+            {
+                epw[i - begin] = Start(capu[i], axn[i], ayn[i]);
+            }
+
+            for (int iteration = 0; iteration < iterations; iteration++)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    epw[i - begin] = Correct(
+                            capu[i], axn[i], ayn[i], epw[i - begin]);
+                }
+            }
+
+            for (size_t i = begin; i < end; i++)
+            {
+                Finish(axn[i], ayn[i], epw[i - begin],
+                        sinepw[i], cosepw[i], ecose[i], esine[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief The equations and solutions of a group of N equations, where
+     * N is known when compiling, such as a group of SIMD lanes.
+     */
+    template <typename T, size_t N>
+    struct Group
+    {
+        /** the mean anomaly plus omega */
+        T capu[N];
+        /** eccentricity * cos(omega) */
+        T axn[N];
+        /** eccentricity * sin(omega) */
+        T ayn[N];
+        /** sine of the solution */
+        T sinepw[N];
+        /** cosine of the solution */
+        T cosepw[N];
+        /** axn * cosepw + ayn * sinepw */
+        T ecose[N];
+        /** axn * sinepw - ayn * cosepw */
+        T esine[N];
+    };
+
+    /**
+     * Solve a group as Solve() does for n equations. The loops have a fixed
+     * trip count and the arrays are known not to overlap, so the compiler
+     * vectorises them at -O2 without a scalar remainder or alias checks.
+     * @param[in,out] group the equations and their solutions
+     */
+    template <typename T, size_t N>
+    static void Solve(Group<T, N>& group)
+    {
+        T epw[N];
+        T elsq = T(0.0);
+
+        for (size_t i = 0; i < N; i++)
+        {
+            const T e2 = group.axn[i] * group.axn[i]
+                + group.ayn[i] * group.ayn[i];
+            elsq = e2 > elsq ? e2 : elsq;
+        }
+
+        const int iterations = Iterations(elsq);
+
+        for (size_t i = 0; i < N; i++)
+        {
+            epw[i] = Start(group.capu[i], group.axn[i], group.ayn[i]);
+        }
+
+        for (int iteration = 0; iteration < iterations; iteration++)
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                epw[i] = Correct(group.capu[i], group.axn[i], group.ayn[i],
+                        epw[i]);
+            }
+        }
+
+        for (size_t i = 0; i < N; i++)
+        {
+            Finish(group.axn[i], group.ayn[i], epw[i],
+                    group.sinepw[i], group.cosepw[i],
+                    group.ecose[i], group.esine[i]);
+        }
+    }
+
+private:
+    /*
+     * encke's starter, e sin(M) / sqrt(1 - 2 e cos(M) + e^2)
+     */
+    template <typename T>
+    static T Start(const T capu, const T axn, const T ayn)
+    {
+        T sinu;
+        T cosu;
+        Util::SinCos(capu, sinu, cosu);
+        const T ecosu = axn * cosu + ayn * sinu;
+        const T esinu = axn * sinu - ayn * cosu;
+
+        return capu + esinu
+            / std::sqrt(T(1.0) - T(2.0) * ecosu + axn * axn + ayn * ayn);
+    }
+
+    /*
+     * danby's fourth order correction
+     */
+    template <typename T>
+    static T Correct(const T capu, const T axn, const T ayn, const T epw)
+    {
+        T sinepw;
+        T cosepw;
+        Util::SinCos(epw, sinepw, cosepw);
+        const T ecose = axn * cosepw + ayn * sinepw;
+        const T esine = axn * sinepw - ayn * cosepw;
+
+        const T f = capu - epw + esine;
+        const T fdot = T(1.0) - ecose;
+        const T delta1 = f / fdot;
+        const T delta2 = f / (fdot + T(0.5) * esine * delta1);
+        const T delta3 = f / (fdot + T(0.5) * esine * delta2
+                + ecose * delta2 * delta2 / T(6.0));
+
+        return epw + delta3;
+    }
+
+    template <typename T>
+    static void Finish(
+            const T axn,
+            const T ayn,
+            const T epw,
+            T& sinepw,
+            T& cosepw,
+            T& ecose,
+            T& esine)
+    {
+        Util::SinCos(epw, sinepw, cosepw);
+        ecose = axn * cosepw + ayn * sinepw;
+        esine = axn * sinepw - ayn * cosepw;
+    }
+};
+
+#endif
@@ -0,0 +1,436 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ModelSnapshot.h"
+
+#include "Globals.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * fnv-1a over 64 bit words, with a shift to fold the high bits back
+     * into the low bits which the multiply does not reach
+     */
+    uint64_t Hash(const void* data, const size_t bytes, uint64_t hash)
+    {
+        static const uint64_t kPrime = 1099511628211ULL;
+        const char* p = static_cast<const char*>(data);
+        size_t i = 0;
+
+        for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, p + i, sizeof(word));
+            hash = (hash ^ word) * kPrime;
+            hash ^= hash >> 29;
+        }
+        for (; i < bytes; i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(p[i])) * kPrime;
+        }
+
+        return hash;
+    }
+
+    const uint64_t kHashStart = 14695981039346656037ULL;
+
+    void Check(const std::ofstream& file)
+    {
+        if (!file.good())
+        {
+            throw ModelSnapshotException("Error writing model snapshot");
+        }
+    }
+}
+
+ModelSnapshot::ModelSnapshot(const std::string& filename)
+    : map_(MAP_FAILED),
+    size_(0),
+    header_(NULL),
+    records_(NULL)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw ModelSnapshotException("Error opening model snapshot");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw ModelSnapshotException("Error reading model snapshot size");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ < sizeof(ModelSnapshotFile::Header))
+    {
+        close(fd);
+        throw ModelSnapshotException("Model snapshot is too short");
+    }
+
+    map_ = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map_ == MAP_FAILED)
+    {
+        throw ModelSnapshotException("Error mapping model snapshot");
+    }
+
+    const char* base = static_cast<const char*>(map_);
+    header_ = reinterpret_cast<const ModelSnapshotFile::Header*>(base);
+    records_ = base + sizeof(ModelSnapshotFile::Header);
+
+    const size_t bytes = size_ - sizeof(ModelSnapshotFile::Header);
+    const char* error = NULL;
+    if (memcmp(header_->magic, ModelSnapshotFile::kMagic,
+                sizeof(header_->magic)) != 0)
+    {
+        error = "Not a model snapshot";
+    }
+    else if (header_->version != ModelSnapshotFile::kVersion)
+    {
+        error = "Unsupported model snapshot version";
+    }
+    else if (header_->constants != Constants()
+            || header_->record_size != RecordSize())
+    {
+        error = "Model snapshot was written with different constants";
+    }
+    else if (header_->models != bytes / RecordSize()
+            || bytes % RecordSize() != 0)
+    {
+        error = "Model snapshot is truncated";
+    }
+    else if (header_->checksum != Hash(records_, bytes, kHashStart))
+    {
+        error = "Model snapshot checksum does not match";
+    }
+
+    if (error != NULL)
+    {
+        munmap(map_, size_);
+        throw ModelSnapshotException(error);
+    }
+}
+
+ModelSnapshot::~ModelSnapshot()
+{
+    munmap(map_, size_);
+}
+
+/*
+ * identifies the layout of a record and the physical constants used to
+ * initialise the models. the offset of every field is hashed by name, so
+ * reordering fields of the same size changes the result as well as adding
+ * or resizing them. the values are hashed as stored, so a file from a
+ * machine with a different byte order is also refused
+ */
+uint64_t ModelSnapshot::Constants()
+{
+    typedef ModelSnapshotFile::Elements Elements;
+    typedef SGP4::CommonConstants Common;
+    typedef SGP4::NearSpaceConstants NearSpace;
+    typedef SGP4::DeepSpaceConstants DeepSpace;
+    typedef SGP4::IntegratorConstants Integrator;
+    typedef SGP4::IntegratorValues Values;
+
+    const uint64_t layout[] =
+    {
+        ModelSnapshotFile::kVersion,
+        sizeof(Elements),
+        offsetof(Elements, mean_anomaly),
+        offsetof(Elements, ascending_node),
+        offsetof(Elements, argument_perigee),
+        offsetof(Elements, eccentricity),
+        offsetof(Elements, inclination),
+        offsetof(Elements, mean_motion),
+        offsetof(Elements, bstar),
+        offsetof(Elements, recovered_semi_major_axis),
+        offsetof(Elements, recovered_mean_motion),
+        offsetof(Elements, perigee),
+        offsetof(Elements, period),
+        offsetof(Elements, epoch),
+        offsetof(Elements, norad_number),
+        offsetof(Elements, use_simple_model),
+        offsetof(Elements, use_deep_space),
+        sizeof(Common),
+        offsetof(Common, cosio),
+        offsetof(Common, sinio),
+        offsetof(Common, eta),
+        offsetof(Common, t2cof),
+        offsetof(Common, a3ovk2),
+        offsetof(Common, x1mth2),
+        offsetof(Common, x3thm1),
+        offsetof(Common, x7thm1),
+        offsetof(Common, aycof),
+        offsetof(Common, xlcof),
+        offsetof(Common, xnodcf),
+        offsetof(Common, c1),
+        offsetof(Common, c4),
+        offsetof(Common, omgdot),
+        offsetof(Common, xnodot),
+        offsetof(Common, xmdot),
+        sizeof(NearSpace),
+        offsetof(NearSpace, c5),
+        offsetof(NearSpace, omgcof),
+        offsetof(NearSpace, xmcof),
+        offsetof(NearSpace, delmo),
+        offsetof(NearSpace, sinmo),
+        offsetof(NearSpace, d2),
+        offsetof(NearSpace, d3),
+        offsetof(NearSpace, d4),
+        offsetof(NearSpace, t3cof),
+        offsetof(NearSpace, t4cof),
+        offsetof(NearSpace, t5cof),
+        sizeof(DeepSpace),
+        offsetof(DeepSpace, gsto),
+        offsetof(DeepSpace, zmol),
+        offsetof(DeepSpace, zmos),
+        offsetof(DeepSpace, resonance_flag),
+        offsetof(DeepSpace, synchronous_flag),
+        offsetof(DeepSpace, sse),
+        offsetof(DeepSpace, ssi),
+        offsetof(DeepSpace, ssl),
+        offsetof(DeepSpace, ssg),
+        offsetof(DeepSpace, ssh),
+        offsetof(DeepSpace, se2),
+        offsetof(DeepSpace, si2),
+        offsetof(DeepSpace, sl2),
+        offsetof(DeepSpace, sgh2),
+        offsetof(DeepSpace, sh2),
+        offsetof(DeepSpace, se3),
+        offsetof(DeepSpace, si3),
+        offsetof(DeepSpace, sl3),
+        offsetof(DeepSpace, sgh3),
+        offsetof(DeepSpace, sh3),
+        offsetof(DeepSpace, sl4),
+        offsetof(DeepSpace, sgh4),
+        offsetof(DeepSpace, ee2),
+        offsetof(DeepSpace, e3),
+        offsetof(DeepSpace, xi2),
+        offsetof(DeepSpace, xi3),
+        offsetof(DeepSpace, xl2),
+        offsetof(DeepSpace, xl3),
+        offsetof(DeepSpace, xl4),
+        offsetof(DeepSpace, xgh2),
+        offsetof(DeepSpace, xgh3),
+        offsetof(DeepSpace, xgh4),
+        offsetof(DeepSpace, xh2),
+        offsetof(DeepSpace, xh3),
+        offsetof(DeepSpace, d2201),
+        offsetof(DeepSpace, d2211),
+        offsetof(DeepSpace, d3210),
+        offsetof(DeepSpace, d3222),
+        offsetof(DeepSpace, d4410),
+        offsetof(DeepSpace, d4422),
+        offsetof(DeepSpace, d5220),
+        offsetof(DeepSpace, d5232),
+        offsetof(DeepSpace, d5421),
+        offsetof(DeepSpace, d5433),
+        offsetof(DeepSpace, del1),
+        offsetof(DeepSpace, del2),
+        offsetof(DeepSpace, del3),
+        sizeof(Integrator),
+        offsetof(Integrator, xfact),
+        offsetof(Integrator, xlamo),
+        offsetof(Integrator, values_0),
+        sizeof(Values),
+        offsetof(Values, xndot),
+        offsetof(Values, xnddt),
+        offsetof(Values, xldot)
+    };
+    const double values[] =
+    {
+        kAE, kQ0, kS0, kMU, kXKMPER, kXJ2, kXJ3, kXJ4, kXKE, kCK2, kCK4,
+        kQOMS2T, kS, kTHDT, kF, kOMEGA_E
+    };
+
+    return Hash(values, sizeof(values),
+            Hash(layout, sizeof(layout), kHashStart));
+}
+
+size_t ModelSnapshot::RecordSize()
+{
+    return sizeof(ModelSnapshotFile::Elements)
+        + sizeof(SGP4::CommonConstants)
+        + sizeof(SGP4::NearSpaceConstants)
+        + sizeof(SGP4::DeepSpaceConstants)
+        + sizeof(SGP4::IntegratorConstants);
+}
+
+void ModelSnapshot::Write(
+        const std::string& filename,
+        const std::vector<SGP4>& models)
+{
+    std::ofstream file(filename.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw ModelSnapshotException("Error creating model snapshot");
+    }
+
+    /*
+     * reserve space for the header, which is written once the checksum
+     * of the records is known
+     */
+    ModelSnapshotFile::Header header = ModelSnapshotFile::Header();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    Check(file);
+
+    std::vector<char> record(RecordSize());
+    uint64_t checksum = kHashStart;
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const SGP4& model = models[i];
+        const OrbitalElements& elements = model.elements_;
+        ModelSnapshotFile::Elements saved = ModelSnapshotFile::Elements();
+        saved.mean_anomaly = elements.mean_anomoly_;
+        saved.ascending_node = elements.ascending_node_;
+        saved.argument_perigee = elements.argument_perigee_;
+        saved.eccentricity = elements.eccentricity_;
+        saved.inclination = elements.inclination_;
+        saved.mean_motion = elements.mean_motion_;
+        saved.bstar = elements.bstar_;
+        saved.recovered_semi_major_axis =
+            elements.recovered_semi_major_axis_;
+        saved.recovered_mean_motion = elements.recovered_mean_motion_;
+        saved.perigee = elements.perigee_;
+        saved.period = elements.period_;
+        saved.epoch = elements.epoch_.Ticks();
+        saved.norad_number = elements.norad_number_;
+        saved.use_simple_model = model.use_simple_model_ ? 1 : 0;
+        saved.use_deep_space = model.use_deep_space_ ? 1 : 0;
+
+        char* p = &record[0];
+        memcpy(p, &saved, sizeof(saved));
+        p += sizeof(saved);
+        memcpy(p, &model.common_consts_, sizeof(model.common_consts_));
+        p += sizeof(model.common_consts_);
+        memcpy(p, &model.nearspace_consts_, sizeof(model.nearspace_consts_));
+        p += sizeof(model.nearspace_consts_);
+        memcpy(p, &model.deepspace_consts_, sizeof(model.deepspace_consts_));
+        p += sizeof(model.deepspace_consts_);
+        memcpy(p, &model.integrator_consts_,
+                sizeof(model.integrator_consts_));
+
+        checksum = Hash(&record[0], record.size(), checksum);
+        file.write(&record[0], static_cast<std::streamsize>(record.size()));
+        Check(file);
+    }
+
+    memcpy(header.magic, ModelSnapshotFile::kMagic, sizeof(header.magic));
+    header.version = ModelSnapshotFile::kVersion;
+    header.record_size = static_cast<uint32_t>(RecordSize());
+    header.constants = Constants();
+    header.models = models.size();
+    header.checksum = checksum;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    Check(file);
+
+    file.close();
+    Check(file);
+}
+
+const char* ModelSnapshot::Record(const size_t i) const
+{
+    if (i >= Size())
+    {
+        throw ModelSnapshotException("Model is not in the snapshot");
+    }
+
+    return records_ + i * RecordSize();
+}
+
+unsigned int ModelSnapshot::NoradNumber(const size_t i) const
+{
+    ModelSnapshotFile::Elements saved;
+    memcpy(&saved, Record(i), sizeof(saved));
+
+    return saved.norad_number;
+}
+
+SGP4 ModelSnapshot::Model(const size_t i) const
+{
+    /*
+     * copy each part out of the map, rather than casting the record
+     */
+    const char* p = Record(i);
+    ModelSnapshotFile::Elements saved;
+    memcpy(&saved, p, sizeof(saved));
+    p += sizeof(saved);
+
+    SGP4::CommonConstants common_consts;
+    memcpy(&common_consts, p, sizeof(common_consts));
+    p += sizeof(common_consts);
+    SGP4::NearSpaceConstants nearspace_consts;
+    memcpy(&nearspace_consts, p, sizeof(nearspace_consts));
+    p += sizeof(nearspace_consts);
+    SGP4::DeepSpaceConstants deepspace_consts;
+    memcpy(&deepspace_consts, p, sizeof(deepspace_consts));
+    p += sizeof(deepspace_consts);
+    SGP4::IntegratorConstants integrator_consts;
+    memcpy(&integrator_consts, p, sizeof(integrator_consts));
+
+    OrbitalElements elements;
+    elements.mean_anomoly_ = saved.mean_anomaly;
+    elements.ascending_node_ = saved.ascending_node;
+    elements.argument_perigee_ = saved.argument_perigee;
+    elements.eccentricity_ = saved.eccentricity;
+    elements.inclination_ = saved.inclination;
+    elements.mean_motion_ = saved.mean_motion;
+    elements.bstar_ = saved.bstar;
+    elements.recovered_semi_major_axis_ = saved.recovered_semi_major_axis;
+    elements.recovered_mean_motion_ = saved.recovered_mean_motion;
+    elements.perigee_ = saved.perigee;
+    elements.period_ = saved.period;
+    elements.epoch_ = DateTime(static_cast<unsigned long long>(saved.epoch));
+    elements.norad_number_ = saved.norad_number;
+
+    return SGP4(elements,
+            common_consts,
+            nearspace_consts,
+            deepspace_consts,
+            integrator_consts,
+            saved.use_simple_model != 0,
+            saved.use_deep_space != 0);
+}
+
+std::vector<SGP4> ModelSnapshot::Models() const
+{
+    std::vector<SGP4> models;
+    models.reserve(Size());
+
+    for (size_t i = 0; i < Size(); i++)
+    {
+        models.push_back(Model(i));
+    }
+
+    return models;
+}
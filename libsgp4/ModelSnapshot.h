@@ -0,0 +1,105 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODELSNAPSHOT_H_
+#define MODELSNAPSHOT_H_
+
+#include "ModelSnapshotFile.h"
+#include "ModelSnapshotException.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A binary snapshot of initialised models.
+ *
+ * Write() saves the elements of each model together with the constants
+ * which SGP4 found when initialising it. Opening the snapshot maps the
+ * file into memory, and the models are rebuilt by copying the constants
+ * back, without repeating the work of initialisation, so that a large
+ * catalog is ready to propagate as soon as it has been read.
+ *
+ * The snapshot is only accepted by a library with the same record layout
+ * and physical constants as the one which wrote it, and with records that
+ * match their checksum. Otherwise the models should be initialised from
+ * their elements again.
+ */
+class ModelSnapshot
+{
+public:
+    /**
+     * Map a snapshot and check it.
+     * @param[in] filename the file to read
+     * @exception ModelSnapshotException if the file cannot be read, is not
+     * a snapshot, was written with different constants or is corrupt
+     */
+    ModelSnapshot(const std::string& filename);
+
+    virtual ~ModelSnapshot();
+
+    /**
+     * Write a snapshot of models.
+     * @param[in] filename the file to create
+     * @param[in] models the models
+     * @exception ModelSnapshotException if the file cannot be written
+     */
+    static void Write(
+            const std::string& filename,
+            const std::vector<SGP4>& models);
+
+    /**
+     * @returns the number of models
+     */
+    size_t Size() const
+    {
+        return static_cast<size_t>(header_->models);
+    }
+
+    /**
+     * @param[in] i the position of the model in the snapshot
+     * @returns the norad number of the model
+     */
+    unsigned int NoradNumber(const size_t i) const;
+
+    /**
+     * @param[in] i the position of the model in the snapshot
+     * @returns the model
+     */
+    SGP4 Model(const size_t i) const;
+
+    /**
+     * @returns every model, in the order they were written
+     */
+    std::vector<SGP4> Models() const;
+
+private:
+    ModelSnapshot(const ModelSnapshot&);
+    ModelSnapshot& operator=(const ModelSnapshot&);
+
+    static uint64_t Constants();
+    static size_t RecordSize();
+    const char* Record(const size_t i) const;
+
+    void* map_;
+    size_t size_;
+    const ModelSnapshotFile::Header* header_;
+    const char* records_;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODELSNAPSHOTEXCEPTION_H_
+#define MODELSNAPSHOTEXCEPTION_H_
+
+#include <exception>
+#include <string>
+
+/**
+ * @brief The exception that ModelSnapshot throws on an error.
+ *
+ * Thrown when a file cannot be read or written, is not a valid model
+ * snapshot, or was written by a library with different constants.
+ */
+class ModelSnapshotException : public std::exception
+{
+public:
+    /**
+     * Constructor
+     * @param message Exception message
+     */
+    ModelSnapshotException(const char* message)
+        : m_message(message)
+    {
+    }
+
+    /**
+     * Destructor
+     */
+    virtual ~ModelSnapshotException(void) throw ()
+    {
+    }
+
+    /**
+     * Get the exception message
+     * @returns the exception message
+     */
+    virtual const char* what() const throw ()
+    {
+        return m_message.c_str();
+    }
+
+private:
+    /** the exception message */
+    std::string m_message;
+};
+
+#endif
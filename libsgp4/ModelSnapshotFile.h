@@ -0,0 +1,80 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODELSNAPSHOTFILE_H_
+#define MODELSNAPSHOTFILE_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Layout of the binary model snapshot file.
+ *
+ * The file is a Header, then one record of record_size bytes for each
+ * model. A record is the Elements of the model followed by the constants
+ * found when it was initialised, whose layout is private to the library.
+ * The constants field of the header identifies the layout and the physical
+ * constants of the library which wrote the file, and the checksum covers
+ * every record. Values are stored in the byte order of the machine that
+ * wrote the file.
+ */
+namespace ModelSnapshotFile
+{
+    const char kMagic[8] = { 'S', 'G', 'P', '4', 'M', 'D', 'L', '\0' };
+    const uint32_t kVersion = 1;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        /** size of a record in bytes */
+        uint32_t record_size;
+        /** identifies the constants of the library */
+        uint64_t constants;
+        /** number of models */
+        uint64_t models;
+        /** checksum of the records */
+        uint64_t checksum;
+        uint64_t reserved;
+    };
+
+    struct Elements
+    {
+        /** angles in radians */
+        double mean_anomaly;
+        double ascending_node;
+        double argument_perigee;
+        double eccentricity;
+        double inclination;
+        /** mean motion in radians per minute */
+        double mean_motion;
+        double bstar;
+        double recovered_semi_major_axis;
+        double recovered_mean_motion;
+        /** perigee in km */
+        double perigee;
+        /** period in minutes */
+        double period;
+        /** ticks of the epoch */
+        int64_t epoch;
+        uint32_t norad_number;
+        uint8_t use_simple_model;
+        uint8_t use_deep_space;
+        uint16_t reserved;
+    };
+}
+
+#endif
@@ -18,6 +18,9 @@
 #include "Observer.h"
 
 #include "CoordTopocentric.h"
+#include "Util.h"
+
+#include <vector>
 
 /*
  * calculate lookangle between the observer and the passed in Eci object
@@ -30,6 +33,87 @@ CoordTopocentric Observer::GetLookAngle(const Eci &eci)
      */
     Update(eci.GetDateTime());
 
+    /*
+     * Calculate Local Mean Sidereal Time for observers longitude
+     */
+    return LookAngle(eci,
+            eci.GetDateTime().ToLocalMeanSiderealTime(m_geo.longitude));
+}
+
+CoordTopocentric Observer::GetLookAngle(
+        const Eci &eci,
+        const TimeContext& time)
+{
+    Update(time);
+
+    return LookAngle(eci, time.LocalMeanSiderealTime(m_geo.longitude));
+}
+
+void Observer::GetLookAngles(
+        const TimeGrid& grid,
+        const double* x,
+        const double* y,
+        const double* z,
+        const double* vx,
+        const double* vy,
+        const double* vz,
+        double* azimuth,
+        double* elevation,
+        double* range,
+        double* range_rate)
+{
+    const size_t n = grid.Size();
+
+    if (n == 0)
+    {
+        return;
+    }
+
+    std::vector<double> gmst(n);
+    grid.SiderealTimes(&gmst[0]);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const DateTime dt = grid.At(i);
+
+        if (m_eci != dt)
+        {
+            m_eci.Update(dt, gmst[i], m_geo);
+        }
+
+        Vector velocity;
+        if (vx != NULL)
+        {
+            velocity = Vector(vx[i], vy[i], vz[i]);
+        }
+
+        const CoordTopocentric topo = LookAngle(
+                Eci(dt, Vector(x[i], y[i], z[i]), velocity),
+                Util::WrapTwoPI(gmst[i] + m_geo.longitude));
+
+        azimuth[i] = topo.azimuth;
+        elevation[i] = topo.elevation;
+        range[i] = topo.range;
+
+        /*
+         * without the velocities the range rate would be that of a
+         * stationary object, so it is left alone
+         */
+        if (range_rate != NULL && vx != NULL)
+        {
+            range_rate[i] = topo.range_rate;
+        }
+    }
+}
+
+/*
+ * look angle with the local mean sidereal time already known, the
+ * observers Eci must be up to date
+ */
+CoordTopocentric Observer::LookAngle(
+        const Eci &eci,
+        const double theta) const
+{
     /*
      * calculate differences
      */
@@ -38,15 +122,12 @@ CoordTopocentric Observer::GetLookAngle(const Eci &eci)
 
     range.w = range.Magnitude();
 
-    /*
-     * Calculate Local Mean Sidereal Time for observers longitude
-     */
-    double theta = eci.GetDateTime().ToLocalMeanSiderealTime(m_geo.longitude);
-
-    double sin_lat = sin(m_geo.latitude);
-    double cos_lat = cos(m_geo.latitude);
-    double sin_theta = sin(theta);
-    double cos_theta = cos(theta);
+    double sin_lat;
+    double cos_lat;
+    double sin_theta;
+    double cos_theta;
+    Util::SinCos(m_geo.latitude, sin_lat, cos_lat);
+    Util::SinCos(theta, sin_theta, cos_theta);
 
     double top_s = sin_lat * cos_theta * range.x
         + sin_lat * sin_theta * range.y - cos_lat * range.z;
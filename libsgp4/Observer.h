@@ -20,6 +20,9 @@
 
 #include "CoordGeodetic.h"
 #include "Eci.h"
+#include "TimeGrid.h"
+
+#include <cstddef>
 
 class DateTime;
 class CoordTopocentric;
@@ -87,7 +90,51 @@ public:
      */
     CoordTopocentric GetLookAngle(const Eci &eci);
 
+    /**
+     * Get the look angle using the sidereal time of a context, which
+     * must be for the date of eci
+     * @param[in] eci the object to find the look angle to
+     * @param[in] time the context for the date of eci
+     * @returns the lookup angle
+     */
+    CoordTopocentric GetLookAngle(const Eci &eci, const TimeContext& time);
+
+    /**
+     * Get the look angles to an object at every time of a grid, from
+     * positions such as those written by SGP4::FindPositions(). The
+     * sidereal times of the grid are found in one pass. Each buffer must
+     * hold grid.Size() values.
+     * @param[in] grid the times
+     * @param[in] x position x in km
+     * @param[in] y position y in km
+     * @param[in] z position z in km
+     * @param[in] vx velocity x in km/s
+     * @param[in] vy velocity y in km/s
+     * @param[in] vz velocity z in km/s
+     * @param[out] azimuth azimuth in radians
+     * @param[out] elevation elevation in radians
+     * @param[out] range range in km
+     * @param[out] range_rate range rate in km/s
+     *
+     * The range rate is only written if range_rate and vx, vy and vz are
+     * not NULL, the velocities are not needed otherwise.
+     */
+    void GetLookAngles(
+            const TimeGrid& grid,
+            const double* x,
+            const double* y,
+            const double* z,
+            const double* vx,
+            const double* vy,
+            const double* vz,
+            double* azimuth,
+            double* elevation,
+            double* range,
+            double* range_rate);
+
 private:
+    CoordTopocentric LookAngle(const Eci &eci, const double theta) const;
+
     /**
      * @param[in] dt the date to update the observers position for
      */
@@ -99,6 +146,17 @@ private:
         }
     }
 
+    /**
+     * @param[in] time the time to update the observers position for
+     */
+    void Update(const TimeContext& time)
+    {
+        if (m_eci != time.GetDateTime())
+        {
+            m_eci.Update(time, m_geo);
+        }
+    }
+
     /** the observers position */
     CoordGeodetic m_geo;
     /** the observers Eci for a particular time */
@@ -0,0 +1,672 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "OmmCatalog.h"
+
+#include "Util.h"
+
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * a piece of the catalog text
+     */
+    struct Span
+    {
+        const char* text;
+        size_t length;
+    };
+
+    enum Field
+    {
+        FIELD_OBJECT_NAME,
+        FIELD_EPOCH,
+        FIELD_MEAN_MOTION,
+        FIELD_ECCENTRICITY,
+        FIELD_INCLINATION,
+        FIELD_RA_OF_ASC_NODE,
+        FIELD_ARG_OF_PERICENTER,
+        FIELD_MEAN_ANOMALY,
+        FIELD_NORAD_CAT_ID,
+        FIELD_BSTAR,
+        FIELD_MEAN_ELEMENT_THEORY,
+        FIELD_COUNT
+    };
+
+    const char* const kFieldNames[FIELD_COUNT] =
+    {
+        "OBJECT_NAME",
+        "EPOCH",
+        "MEAN_MOTION",
+        "ECCENTRICITY",
+        "INCLINATION",
+        "RA_OF_ASC_NODE",
+        "ARG_OF_PERICENTER",
+        "MEAN_ANOMALY",
+        "NORAD_CAT_ID",
+        "BSTAR",
+        "MEAN_ELEMENT_THEORY"
+    };
+
+    /*
+     * the longest number which is decoded
+     */
+    const size_t kMaxNumber = 64;
+
+    bool Equals(const Span& span, const char* text)
+    {
+        return strlen(text) == span.length
+            && memcmp(span.text, text, span.length) == 0;
+    }
+
+    Span Trim(const char* first, const char* last)
+    {
+        while (first != last && (*first == ' ' || *first == '\t'))
+        {
+            ++first;
+        }
+        while (last != first && (last[-1] == ' ' || last[-1] == '\t'
+                    || last[-1] == '\r'))
+        {
+            --last;
+        }
+
+        Span span;
+        span.text = first;
+        span.length = static_cast<size_t>(last - first);
+        return span;
+    }
+
+    /*
+     * find the line starting at text, and the start of the next one
+     */
+    Span NextLine(const char* text, const char* end, const char*& next)
+    {
+        const char* newline = static_cast<const char*>(
+                memchr(text, '\n', static_cast<size_t>(end - text)));
+        const char* last = newline != NULL ? newline : end;
+        next = newline != NULL ? newline + 1 : end;
+
+        return Trim(text, last);
+    }
+
+    /*
+     * the field named by key, or FIELD_COUNT if it is not one which is read
+     */
+    int FindField(const Span& key)
+    {
+        for (int i = 0; i < FIELD_COUNT; i++)
+        {
+            if (Equals(key, kFieldNames[i]))
+            {
+                return i;
+            }
+        }
+
+        return FIELD_COUNT;
+    }
+
+    /*
+     * read a decimal number. strtod also reads nan, inf and hexadecimal,
+     * which a Tle could never hold, so only digits, signs, a point and an
+     * exponent are let through, and numbers too large for a double are
+     * refused
+     */
+    bool ParseDouble(const Span& span, double& value)
+    {
+        char buffer[kMaxNumber];
+
+        if (span.length == 0 || span.length >= kMaxNumber)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < span.length; i++)
+        {
+            const char c = span.text[i];
+
+            if ((c < '0' || c > '9') && c != '+' && c != '-' && c != '.'
+                    && c != 'e' && c != 'E')
+            {
+                return false;
+            }
+        }
+
+        memcpy(buffer, span.text, span.length);
+        buffer[span.length] = '\0';
+
+        char* end;
+        value = strtod(buffer, &end);
+
+        return end == buffer + span.length
+            && value <= DBL_MAX && value >= -DBL_MAX;
+    }
+
+    bool ParseUnsigned(const Span& span, unsigned int& value)
+    {
+        value = 0;
+
+        if (span.length == 0 || span.length > 9)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < span.length; i++)
+        {
+            if (span.text[i] < '0' || span.text[i] > '9')
+            {
+                return false;
+            }
+            value = value * 10 + static_cast<unsigned int>(span.text[i] - '0');
+        }
+
+        return true;
+    }
+
+    /*
+     * read exactly digits digits from text
+     */
+    bool ParseDigits(
+            const char*& text,
+            const char* end,
+            const int digits,
+            int& value)
+    {
+        value = 0;
+
+        for (int i = 0; i < digits; i++, ++text)
+        {
+            if (text == end || *text < '0' || *text > '9')
+            {
+                return false;
+            }
+            value = value * 10 + (*text - '0');
+        }
+
+        return true;
+    }
+
+    bool Expect(const char*& text, const char* end, const char c)
+    {
+        if (text == end || *text != c)
+        {
+            return false;
+        }
+        ++text;
+        return true;
+    }
+
+    /*
+     * an epoch of the form YYYY-MM-DDThh:mm:ss.ffffff or YYYY-DDDThh:mm:ss,
+     * with any number of fractional digits and an optional trailing Z
+     */
+    bool ParseEpoch(const Span& span, DateTime& epoch)
+    {
+        const char* p = span.text;
+        const char* end = span.text + span.length;
+        int year;
+        int month = 1;
+        int day = 1;
+        int day_of_year = 1;
+        int hour;
+        int minute;
+        int second;
+
+        if (!ParseDigits(p, end, 4, year) || !Expect(p, end, '-'))
+        {
+            return false;
+        }
+
+        const char* date = p;
+        while (p != end && *p >= '0' && *p <= '9')
+        {
+            ++p;
+        }
+
+        if (p - date == 3)
+        {
+            p = date;
+            ParseDigits(p, end, 3, day_of_year);
+            if (!DateTime::IsValidYear(year) || day_of_year < 1
+                    || day_of_year > (DateTime::IsLeapYear(year) ? 366 : 365))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            p = date;
+            if (!ParseDigits(p, end, 2, month) || !Expect(p, end, '-')
+                    || !ParseDigits(p, end, 2, day)
+                    || !DateTime::IsValidYearMonthDay(year, month, day))
+            {
+                return false;
+            }
+        }
+
+        if (!Expect(p, end, 'T')
+                || !ParseDigits(p, end, 2, hour) || !Expect(p, end, ':')
+                || !ParseDigits(p, end, 2, minute) || !Expect(p, end, ':')
+                || !ParseDigits(p, end, 2, second)
+                || hour > 23 || minute > 59 || second > 60)
+        {
+            return false;
+        }
+
+        /*
+         * round the fraction to the nearest tick
+         */
+        long long fraction = 0;
+        if (p != end && *p == '.')
+        {
+            ++p;
+            long long scale = TicksPerSecond;
+            long long remainder = 0;
+            while (p != end && *p >= '0' && *p <= '9')
+            {
+                if (scale > 1)
+                {
+                    scale /= 10;
+                    fraction += scale * (*p - '0');
+                }
+                else if (remainder == 0)
+                {
+                    remainder = *p >= '5' ? 1 : -1;
+                }
+                ++p;
+            }
+            fraction += remainder > 0 ? 1 : 0;
+        }
+
+        if (p != end && *p == 'Z')
+        {
+            ++p;
+        }
+        if (p != end)
+        {
+            return false;
+        }
+
+        epoch = DateTime(year, month, day).AddTicks(
+                (day_of_year - 1) * TicksPerDay
+                + hour * TicksPerHour
+                + minute * TicksPerMinute
+                + second * TicksPerSecond
+                + fraction);
+
+        return true;
+    }
+}
+
+/*
+ * the fields of one message, as they appear in the text
+ */
+struct OmmCatalog::Message
+{
+    Message()
+        : line(0)
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        for (int i = 0; i < FIELD_COUNT; i++)
+        {
+            fields[i].text = NULL;
+            fields[i].length = 0;
+        }
+        empty = true;
+    }
+
+    void Set(const int field, const Span& value)
+    {
+        fields[field] = value;
+        empty = false;
+    }
+
+    bool Has(const int field) const
+    {
+        return fields[field].text != NULL;
+    }
+
+    Span fields[FIELD_COUNT];
+    bool empty;
+    /** the line which the message starts on */
+    size_t line;
+};
+
+OmmCatalog::OmmCatalog(const std::string& filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw TleException("Error opening OMM file");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw TleException("Error reading OMM file size");
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        throw TleException("Error mapping OMM file");
+    }
+
+    /*
+     * the file is read once from start to end
+     */
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    try
+    {
+        Parse(static_cast<const char*>(map), size);
+    }
+    catch (...)
+    {
+        munmap(map, size);
+        throw;
+    }
+
+    munmap(map, size);
+}
+
+OmmCatalog::OmmCatalog(const char* text, const size_t length)
+{
+    Parse(text, length);
+}
+
+void OmmCatalog::Parse(const char* text, const size_t length)
+{
+    const char* end = text + length;
+    const char* next = text;
+    size_t number = 0;
+
+    /*
+     * the first line which is not blank tells the encoding
+     */
+    while (next != end)
+    {
+        const char* start = next;
+        const Span line = NextLine(start, end, next);
+        number++;
+
+        if (line.length != 0)
+        {
+            if (memchr(line.text, '=', line.length) != NULL)
+            {
+                ParseKvn(start, end, number);
+            }
+            else
+            {
+                ParseCsv(start, end, number);
+            }
+            return;
+        }
+    }
+}
+
+void OmmCatalog::ParseCsv(const char* text, const char* end, size_t number)
+{
+    const char* next = text;
+    std::vector<int> columns;
+    Message message;
+
+    /*
+     * the header, naming the field of each column
+     */
+    const Span header = NextLine(next, end, next);
+    for (const char* p = header.text; ; )
+    {
+        const char* comma = static_cast<const char*>(memchr(p, ',',
+                    static_cast<size_t>(header.text + header.length - p)));
+        const char* last = comma != NULL ? comma : header.text + header.length;
+        Span name = Trim(p, last);
+
+        if (name.length > 1 && name.text[0] == '"'
+                && name.text[name.length - 1] == '"')
+        {
+            name.text++;
+            name.length -= 2;
+        }
+        columns.push_back(FindField(name));
+
+        if (comma == NULL)
+        {
+            break;
+        }
+        p = comma + 1;
+    }
+
+    while (next != end)
+    {
+        const Span line = NextLine(next, end, next);
+        number++;
+
+        if (line.length == 0)
+        {
+            continue;
+        }
+
+        message.Clear();
+        message.line = number;
+
+        const char* p = line.text;
+        const char* last = line.text + line.length;
+        size_t column = 0;
+        bool valid = true;
+
+        for (;;)
+        {
+            Span value;
+
+            if (p != last && *p == '"')
+            {
+                /*
+                 * a quoted value, which may hold commas
+                 */
+                const char* quote = static_cast<const char*>(memchr(p + 1,
+                            '"', static_cast<size_t>(last - p - 1)));
+                if (quote == NULL)
+                {
+                    valid = false;
+                    break;
+                }
+                value.text = p + 1;
+                value.length = static_cast<size_t>(quote - p - 1);
+                p = quote + 1;
+                while (p != last && *p != ',')
+                {
+                    ++p;
+                }
+            }
+            else
+            {
+                const char* comma = static_cast<const char*>(memchr(p, ',',
+                            static_cast<size_t>(last - p)));
+                const char* stop = comma != NULL ? comma : last;
+                value = Trim(p, stop);
+                p = stop;
+            }
+
+            if (column < columns.size() && columns[column] != FIELD_COUNT
+                    && value.length != 0)
+            {
+                message.Set(columns[column], value);
+            }
+            column++;
+
+            if (p == last)
+            {
+                break;
+            }
+            ++p;
+        }
+
+        if (valid)
+        {
+            Add(message);
+        }
+        else
+        {
+            rejected_.push_back(number);
+        }
+    }
+}
+
+void OmmCatalog::ParseKvn(const char* text, const char* end, size_t number)
+{
+    const char* next = text;
+    Message message;
+
+    /*
+     * number counts the first line, which is read again here
+     */
+    number--;
+
+    while (next != end)
+    {
+        const Span line = NextLine(next, end, next);
+        number++;
+
+        const char* equals = static_cast<const char*>(
+                memchr(line.text, '=', line.length));
+
+        if (equals == NULL)
+        {
+            continue;
+        }
+
+        const Span key = Trim(line.text, equals);
+        Span value = Trim(equals + 1, line.text + line.length);
+
+        /*
+         * drop any units, as in MEAN_MOTION = 15.5 [rev/day]
+         */
+        if (value.length != 0 && value.text[value.length - 1] == ']')
+        {
+            const char* bracket = value.text + value.length - 1;
+            while (bracket != value.text && *bracket != '[')
+            {
+                --bracket;
+            }
+            if (*bracket == '[')
+            {
+                value = Trim(value.text, bracket);
+            }
+        }
+
+        const int field = FindField(key);
+        const bool starts = Equals(key, "CCSDS_OMM_VERS")
+            || (field != FIELD_COUNT && message.Has(field));
+
+        if (starts && !message.empty)
+        {
+            Add(message);
+            message.Clear();
+        }
+        if (message.empty && (starts || field != FIELD_COUNT))
+        {
+            message.line = number;
+        }
+        if (field != FIELD_COUNT)
+        {
+            message.Set(field, value);
+        }
+    }
+
+    if (!message.empty)
+    {
+        Add(message);
+    }
+}
+
+void OmmCatalog::Add(const Message& message)
+{
+    double mean_motion;
+    double eccentricity;
+    double inclination;
+    double ascending_node;
+    double argument_perigee;
+    double mean_anomaly;
+    double bstar;
+    unsigned int norad_number;
+    DateTime epoch;
+
+    /*
+     * both spellings of the theory in use for SGP4 elements are accepted,
+     * others such as SGP4-XP are not
+     */
+    const Span& theory = message.fields[FIELD_MEAN_ELEMENT_THEORY];
+
+    if ((message.Has(FIELD_MEAN_ELEMENT_THEORY) && !Equals(theory, "SGP4")
+                && !Equals(theory, "SGP/SGP4"))
+            || !ParseEpoch(message.fields[FIELD_EPOCH], epoch)
+            || !ParseDouble(message.fields[FIELD_MEAN_MOTION], mean_motion)
+            || !ParseDouble(message.fields[FIELD_ECCENTRICITY], eccentricity)
+            || !ParseDouble(message.fields[FIELD_INCLINATION], inclination)
+            || !ParseDouble(message.fields[FIELD_RA_OF_ASC_NODE],
+                ascending_node)
+            || !ParseDouble(message.fields[FIELD_ARG_OF_PERICENTER],
+                argument_perigee)
+            || !ParseDouble(message.fields[FIELD_MEAN_ANOMALY], mean_anomaly)
+            || !ParseDouble(message.fields[FIELD_BSTAR], bstar)
+            || !ParseUnsigned(message.fields[FIELD_NORAD_CAT_ID],
+                norad_number)
+            || eccentricity < 0.0 || eccentricity >= 1.0
+            || mean_motion <= 0.0)
+    {
+        rejected_.push_back(message.line);
+        return;
+    }
+
+    elements_.push_back(OrbitalElements(
+                Util::DegreesToRadians(mean_anomaly),
+                Util::DegreesToRadians(ascending_node),
+                Util::DegreesToRadians(argument_perigee),
+                eccentricity,
+                Util::DegreesToRadians(inclination),
+                mean_motion,
+                bstar,
+                epoch,
+                norad_number));
+
+    const Span& name = message.fields[FIELD_OBJECT_NAME];
+    names_.push_back(message.Has(FIELD_OBJECT_NAME)
+            ? std::string(name.text, name.length) : std::string());
+}
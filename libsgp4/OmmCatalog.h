@@ -0,0 +1,130 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef OMMCATALOG_H_
+#define OMMCATALOG_H_
+
+#include "OrbitalElements.h"
+#include "TleException.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loads a catalog of CCSDS orbit mean elements messages in bulk.
+ *
+ * The file is mapped into memory and each message is decoded in place
+ * straight into OrbitalElements, so the elements keep the full precision
+ * of the message rather than the fixed columns of a Tle. Two encodings are
+ * read, told apart by the first line:
+ *
+ * - CSV, a header line naming the fields followed by one line for each
+ *   message, as served by CelesTrak and Space-Track.
+ * - KVN, lines of the form KEY = value. A message starts at each
+ *   CCSDS_OMM_VERS line, or when a field is given for the second time.
+ *   COMMENT lines and units in square brackets are ignored.
+ *
+ * The fields read are OBJECT_NAME, EPOCH, MEAN_MOTION, ECCENTRICITY,
+ * INCLINATION, RA_OF_ASC_NODE, ARG_OF_PERICENTER, MEAN_ANOMALY,
+ * NORAD_CAT_ID, BSTAR and MEAN_ELEMENT_THEORY, and any others are skipped.
+ * Messages with a missing or malformed field, or for a theory other than
+ * SGP4 (written SGP4 or SGP/SGP4), are rejected and left out, and the line
+ * numbers where they start are recorded instead. As with a Tle, numbers
+ * must be plain decimals, so nan, inf and hexadecimal are malformed, and so
+ * are an eccentricity outside [0, 1) and a mean motion which is not
+ * positive.
+ */
+class OmmCatalog
+{
+public:
+    /**
+     * Load a catalog from a file.
+     * @param[in] filename the file to read
+     * @exception TleException if the file cannot be read
+     */
+    OmmCatalog(const std::string& filename);
+
+    /**
+     * Load a catalog from text already in memory.
+     * @param[in] text the text of the catalog
+     * @param[in] length the length of the text
+     */
+    OmmCatalog(const char* text, const size_t length);
+
+    virtual ~OmmCatalog()
+    {
+    }
+
+    /**
+     * @returns the number of messages loaded
+     */
+    size_t Size() const
+    {
+        return elements_.size();
+    }
+
+    /**
+     * @param[in] i the message, below Size()
+     * @returns the elements of the message, in the order of the file
+     */
+    const OrbitalElements& operator[](const size_t i) const
+    {
+        return elements_[i];
+    }
+
+    /**
+     * @returns the elements of every message loaded, in the order of the
+     * file
+     */
+    const std::vector<OrbitalElements>& Elements() const
+    {
+        return elements_;
+    }
+
+    /**
+     * @param[in] i the message, below Size()
+     * @returns the object name of the message, empty if it has none
+     */
+    const std::string& Name(const size_t i) const
+    {
+        return names_[i];
+    }
+
+    /**
+     * @returns the line numbers, counting from one, of the first lines of
+     * the messages which were rejected
+     */
+    const std::vector<size_t>& Rejected() const
+    {
+        return rejected_;
+    }
+
+private:
+    struct Message;
+
+    void Parse(const char* text, const size_t length);
+    void ParseCsv(const char* text, const char* end, size_t number);
+    void ParseKvn(const char* text, const char* end, size_t number);
+    void Add(const Message& message);
+
+    std::vector<OrbitalElements> elements_;
+    std::vector<std::string> names_;
+    std::vector<size_t> rejected_;
+};
+
+#endif
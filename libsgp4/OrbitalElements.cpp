@@ -18,20 +18,79 @@
 #include "OrbitalElements.h"
 
 #include "Tle.h"
+#include "TleRecord.h"
 
 OrbitalElements::OrbitalElements(const Tle& tle)
 {
     /*
      * extract and format tle data
      */
-    mean_anomoly_ = tle.MeanAnomaly(false);
-    ascending_node_ = tle.RightAscendingNode(false);
-    argument_perigee_ = tle.ArgumentPerigee(false);
-    eccentricity_ = tle.Eccentricity();
-    inclination_ = tle.Inclination(false);
-    mean_motion_ = tle.MeanMotion() * kTWOPI / kMINUTES_PER_DAY;
-    bstar_ = tle.BStar();
-    epoch_ = tle.Epoch();
+    Initialise(tle.MeanAnomaly(false),
+            tle.RightAscendingNode(false),
+            tle.ArgumentPerigee(false),
+            tle.Eccentricity(),
+            tle.Inclination(false),
+            tle.MeanMotion(),
+            tle.BStar(),
+            tle.Epoch(),
+            tle.NoradNumber());
+}
+
+OrbitalElements::OrbitalElements(const TleRecord& record)
+{
+    Initialise(Util::DegreesToRadians(record.mean_anomaly),
+            Util::DegreesToRadians(record.right_ascending_node),
+            Util::DegreesToRadians(record.argument_perigee),
+            record.eccentricity,
+            Util::DegreesToRadians(record.inclination),
+            record.mean_motion,
+            record.bstar,
+            DateTime(record.epoch),
+            record.norad_number);
+}
+
+OrbitalElements::OrbitalElements(
+        const double mean_anomaly,
+        const double ascending_node,
+        const double argument_perigee,
+        const double eccentricity,
+        const double inclination,
+        const double mean_motion,
+        const double bstar,
+        const DateTime& epoch,
+        const unsigned int norad_number)
+{
+    Initialise(mean_anomaly,
+            ascending_node,
+            argument_perigee,
+            eccentricity,
+            inclination,
+            mean_motion,
+            bstar,
+            epoch,
+            norad_number);
+}
+
+void OrbitalElements::Initialise(
+        const double mean_anomaly,
+        const double ascending_node,
+        const double argument_perigee,
+        const double eccentricity,
+        const double inclination,
+        const double mean_motion,
+        const double bstar,
+        const DateTime& epoch,
+        const unsigned int norad_number)
+{
+    mean_anomoly_ = mean_anomaly;
+    ascending_node_ = ascending_node;
+    argument_perigee_ = argument_perigee;
+    eccentricity_ = eccentricity;
+    inclination_ = inclination;
+    mean_motion_ = mean_motion * kTWOPI / kMINUTES_PER_DAY;
+    bstar_ = bstar;
+    epoch_ = epoch;
+    norad_number_ = norad_number;
 
     /*
      * recover original mean motion (xnodp) and semimajor axis (aodp)
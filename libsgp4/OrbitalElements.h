@@ -22,14 +22,43 @@
 #include "DateTime.h"
 
 class Tle;
+struct TleRecord;
 
 /**
  * @brief The extracted orbital elements used by the SGP4 propagator.
  */
 class OrbitalElements
 {
+    friend class ModelSnapshot;
+
 public:
     OrbitalElements(const Tle& tle);
+    OrbitalElements(const TleRecord& record);
+
+    /**
+     * Constructor from mean elements, such as those of an orbit mean
+     * elements message, without going through the text of a Tle.
+     * @param[in] mean_anomaly the mean anomaly in radians
+     * @param[in] ascending_node the right ascension of the ascending node in
+     * radians
+     * @param[in] argument_perigee the argument of perigee in radians
+     * @param[in] eccentricity the eccentricity
+     * @param[in] inclination the inclination in radians
+     * @param[in] mean_motion the mean motion in revolutions per day
+     * @param[in] bstar the drag term in inverse earth radii
+     * @param[in] epoch the epoch
+     * @param[in] norad_number the norad number
+     */
+    OrbitalElements(
+            const double mean_anomaly,
+            const double ascending_node,
+            const double argument_perigee,
+            const double eccentricity,
+            const double inclination,
+            const double mean_motion,
+            const double bstar,
+            const DateTime& epoch,
+            const unsigned int norad_number);
 
     virtual ~OrbitalElements()
     {
@@ -131,7 +160,30 @@ public:
         return epoch_;
     }
 
+    /*
+     * NORAD catalogue number
+     */
+    unsigned int NoradNumber() const
+    {
+        return norad_number_;
+    }
+
 private:
+    OrbitalElements()
+    {
+    }
+
+    void Initialise(
+            const double mean_anomaly,
+            const double ascending_node,
+            const double argument_perigee,
+            const double eccentricity,
+            const double inclination,
+            const double mean_motion,
+            const double bstar,
+            const DateTime& epoch,
+            const unsigned int norad_number);
+
     double mean_anomoly_;
     double ascending_node_;
     double argument_perigee_;
@@ -144,6 +196,7 @@ private:
     double perigee_;
     double period_;
     DateTime epoch_;
+    unsigned int norad_number_;
 };
 
 #endif
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "PropagationCache.h"
+
+#include "OrbitalElements.h"
+#include "Threads.h"
+
+PropagationCache::Entry::Entry(const Key& k, const double* e, const Eci& r)
+    : key(k),
+    eci(r)
+{
+    for (size_t i = 0; i < kElements; i++)
+    {
+        elements[i] = e[i];
+    }
+}
+
+PropagationCache::Shard::Shard()
+    : hits(0),
+    misses(0)
+{
+    pthread_mutex_init(&mutex, NULL);
+}
+
+PropagationCache::Shard::~Shard()
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+PropagationCache::PropagationCache(const size_t capacity, const size_t shards)
+    : shard_count_(shards > 0 ? shards : 1),
+    shards_(NULL)
+{
+    /*
+     * each shard holds an equal part of the capacity, and at least one
+     */
+    capacity_ = capacity / shard_count_;
+    if (capacity_ == 0)
+    {
+        capacity_ = 1;
+    }
+
+    shards_ = new Shard[shard_count_];
+}
+
+PropagationCache::~PropagationCache()
+{
+    delete[] shards_;
+}
+
+Eci PropagationCache::FindPosition(const SGP4& model, const DateTime& date)
+{
+    const OrbitalElements& elements = model.Elements();
+    Key key;
+    key.norad_number = elements.NoradNumber();
+    key.epoch = elements.Epoch().Ticks();
+    key.ticks = date.Ticks();
+
+    double current[kElements];
+    GetElements(model, current);
+
+    Shard& shard = ShardFor(key);
+
+    {
+        Threads::ScopedLock lock(shard.mutex);
+        EntryMap::iterator itr = shard.index.find(key);
+
+        if (itr != shard.index.end())
+        {
+            if (SameElements(itr->second->elements, current))
+            {
+                shard.hits++;
+                shard.entries.splice(shard.entries.begin(),
+                        shard.entries,
+                        itr->second);
+                return itr->second->eci;
+            }
+
+            /*
+             * the elements have been replaced since this was cached
+             */
+            shard.entries.erase(itr->second);
+            shard.index.erase(itr);
+        }
+
+        shard.misses++;
+    }
+
+    /*
+     * the model may be shared with other threads using the cache, so it
+     * is propagated with a context of this call's own rather than the one
+     * inside the model
+     */
+    SGP4::Context context;
+    const Eci eci = model.FindPosition(date, context);
+
+    Threads::ScopedLock lock(shard.mutex);
+
+    /*
+     * another thread may have cached the same result while this one was
+     * propagating
+     */
+    if (shard.index.find(key) == shard.index.end())
+    {
+        shard.entries.push_front(Entry(key, current, eci));
+        shard.index[key] = shard.entries.begin();
+
+        if (shard.entries.size() > capacity_)
+        {
+            shard.index.erase(shard.entries.back().key);
+            shard.entries.pop_back();
+        }
+    }
+
+    return eci;
+}
+
+unsigned long long PropagationCache::Hits() const
+{
+    unsigned long long hits = 0;
+
+    for (size_t i = 0; i < shard_count_; i++)
+    {
+        Threads::ScopedLock lock(shards_[i].mutex);
+        hits += shards_[i].hits;
+    }
+
+    return hits;
+}
+
+unsigned long long PropagationCache::Misses() const
+{
+    unsigned long long misses = 0;
+
+    for (size_t i = 0; i < shard_count_; i++)
+    {
+        Threads::ScopedLock lock(shards_[i].mutex);
+        misses += shards_[i].misses;
+    }
+
+    return misses;
+}
+
+size_t PropagationCache::Size() const
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < shard_count_; i++)
+    {
+        Threads::ScopedLock lock(shards_[i].mutex);
+        size += shards_[i].index.size();
+    }
+
+    return size;
+}
+
+void PropagationCache::Clear()
+{
+    for (size_t i = 0; i < shard_count_; i++)
+    {
+        Threads::ScopedLock lock(shards_[i].mutex);
+        shards_[i].entries.clear();
+        shards_[i].index.clear();
+        shards_[i].hits = 0;
+        shards_[i].misses = 0;
+    }
+}
+
+void PropagationCache::GetElements(const SGP4& model, double* elements)
+{
+    const OrbitalElements& e = model.Elements();
+
+    elements[0] = e.MeanAnomoly();
+    elements[1] = e.AscendingNode();
+    elements[2] = e.ArgumentPerigee();
+    elements[3] = e.Eccentricity();
+    elements[4] = e.Inclination();
+    elements[5] = e.MeanMotion();
+    elements[6] = e.BStar();
+}
+
+bool PropagationCache::SameElements(const double* a, const double* b)
+{
+    for (size_t i = 0; i < kElements; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * spread neighbouring times and satellites over the shards
+ */
+PropagationCache::Shard& PropagationCache::ShardFor(const Key& key) const
+{
+    unsigned long long hash = static_cast<unsigned long long>(key.ticks);
+    hash ^= static_cast<unsigned long long>(key.norad_number)
+        * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 29;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 32;
+
+    return shards_[hash % shard_count_];
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PROPAGATIONCACHE_H_
+#define PROPAGATIONCACHE_H_
+
+#include "SGP4.h"
+#include "Eci.h"
+#include "DateTime.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+
+#include <pthread.h>
+
+/**
+ * @brief A bounded cache of SGP4::FindPosition() results.
+ *
+ * Results are keyed on the norad number, the epoch of the elements and the
+ * time propagated to, and the least recently used result is discarded when
+ * the cache is full. Each result also remembers the elements it was
+ * propagated with, and is only returned for a model with the same
+ * elements, so a model which has had its elements replaced with
+ * SGP4::SetTle() never sees results for the old ones.
+ *
+ * The cache is split into shards, each with its own lock, so it can be
+ * shared between threads, as can the models passed to it. Propagation
+ * happens outside of the lock with a context local to the call, and errors
+ * are thrown as by SGP4 and are not cached.
+ */
+class PropagationCache
+{
+public:
+    /**
+     * @param[in] capacity the number of results to keep
+     * @param[in] shards the number of independently locked shards
+     */
+    PropagationCache(const size_t capacity, const size_t shards = 16);
+
+    virtual ~PropagationCache();
+
+    /**
+     * Return the cached result for the model and date, or propagate the
+     * model and cache the result.
+     * @param[in] model the satellite
+     * @param[in] date the time
+     * @returns the position and velocity
+     * @exception SatelliteException
+     * @exception DecayedException
+     */
+    Eci FindPosition(const SGP4& model, const DateTime& date);
+
+    /**
+     * @returns the number of results found in the cache
+     */
+    unsigned long long Hits() const;
+
+    /**
+     * @returns the number of results which had to be propagated, including
+     * those whose cached result was for other elements
+     */
+    unsigned long long Misses() const;
+
+    /**
+     * @returns the number of cached results
+     */
+    size_t Size() const;
+
+    /**
+     * Discard every cached result and reset the counters.
+     */
+    void Clear();
+
+private:
+    PropagationCache(const PropagationCache&);
+    PropagationCache& operator=(const PropagationCache&);
+
+    struct Key
+    {
+        unsigned int norad_number;
+        long long epoch;
+        long long ticks;
+
+        bool operator<(const Key& key) const
+        {
+            if (norad_number != key.norad_number)
+            {
+                return norad_number < key.norad_number;
+            }
+            if (epoch != key.epoch)
+            {
+                return epoch < key.epoch;
+            }
+            return ticks < key.ticks;
+        }
+    };
+
+    /*
+     * the elements which, with the epoch, determine the result
+     */
+    static const size_t kElements = 7;
+
+    struct Entry
+    {
+        Entry(const Key& k, const double* e, const Eci& r);
+
+        Key key;
+        double elements[kElements];
+        Eci eci;
+    };
+
+    typedef std::list<Entry> EntryList;
+    typedef std::map<Key, EntryList::iterator> EntryMap;
+
+    /*
+     * most recently used entries are at the front of the list
+     */
+    struct Shard
+    {
+        Shard();
+        ~Shard();
+
+        mutable pthread_mutex_t mutex;
+        EntryList entries;
+        EntryMap index;
+        unsigned long long hits;
+        unsigned long long misses;
+    };
+
+    static void GetElements(const SGP4& model, double* elements);
+    static bool SameElements(const double* a, const double* b);
+
+    Shard& ShardFor(const Key& key) const;
+
+    size_t capacity_;
+    size_t shard_count_;
+    Shard* shards_;
+};
+
+#endif
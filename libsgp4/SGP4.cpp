@@ -22,6 +22,7 @@
 #include "SatelliteException.h"
 #include "DecayedException.h"
 
+#include <cfloat>
 #include <cmath>
 #include <iomanip>
 
@@ -30,6 +31,7 @@ const SGP4::NearSpaceConstants SGP4::Empty_NearSpaceConstants = SGP4::NearSpaceC
 const SGP4::DeepSpaceConstants SGP4::Empty_DeepSpaceConstants = SGP4::DeepSpaceConstants();
 const SGP4::IntegratorConstants SGP4::Empty_IntegratorConstants = SGP4::IntegratorConstants();
 const SGP4::IntegratorParams SGP4::Empty_IntegratorParams = SGP4::IntegratorParams();
+unsigned long long SGP4::generations_ = 0;
 
 void SGP4::SetTle(const Tle& tle)
 {
@@ -41,6 +43,13 @@ void SGP4::SetTle(const Tle& tle)
     Initialise();
 }
 
+void SGP4::SetTle(const TleRecord& record)
+{
+    elements_ = OrbitalElements(record);
+
+    Initialise();
+}
+
 void SGP4::Initialise()
 {
     /*
@@ -213,6 +222,70 @@ void SGP4::Initialise()
                     c1sq * (2.0 * nearspace_consts_.d2 + c1sq));
         }
     }
+
+    SelectKernels();
+}
+
+/*
+ * restore a model from constants found by Initialise() for the same
+ * elements, as saved in a ModelSnapshot
+ */
+SGP4::SGP4(
+        const OrbitalElements& elements,
+        const struct CommonConstants& common_consts,
+        const struct NearSpaceConstants& nearspace_consts,
+        const struct DeepSpaceConstants& deepspace_consts,
+        const struct IntegratorConstants& integrator_consts,
+        const bool use_simple_model,
+        const bool use_deep_space)
+    : use_simple_model_(use_simple_model),
+    use_deep_space_(use_deep_space),
+    common_consts_(common_consts),
+    nearspace_consts_(nearspace_consts),
+    deepspace_consts_(deepspace_consts),
+    integrator_consts_(integrator_consts),
+    elements_(elements)
+{
+    generation_ = __atomic_add_fetch(&generations_, 1ULL, __ATOMIC_SEQ_CST);
+    SelectKernels();
+}
+
+/*
+ * select the propagator for this orbit, so that no further checks of the
+ * orbit type are needed when propagating
+ */
+void SGP4::SelectKernels()
+{
+    if (use_deep_space_)
+    {
+        if (!deepspace_consts_.resonance_flag)
+        {
+            kernel_ = &SGP4::FindPositionSDP4<RESONANCE_NONE, true>;
+            position_kernel_ = &SGP4::FindPositionSDP4<RESONANCE_NONE, false>;
+        }
+        else if (deepspace_consts_.synchronous_flag)
+        {
+            kernel_ = &SGP4::FindPositionSDP4<RESONANCE_SYNCHRONOUS, true>;
+            position_kernel_
+                = &SGP4::FindPositionSDP4<RESONANCE_SYNCHRONOUS, false>;
+        }
+        else
+        {
+            kernel_ = &SGP4::FindPositionSDP4<RESONANCE_12_HOUR, true>;
+            position_kernel_
+                = &SGP4::FindPositionSDP4<RESONANCE_12_HOUR, false>;
+        }
+    }
+    else if (use_simple_model_)
+    {
+        kernel_ = &SGP4::FindPositionSGP4<true, true>;
+        position_kernel_ = &SGP4::FindPositionSGP4<true, false>;
+    }
+    else
+    {
+        kernel_ = &SGP4::FindPositionSGP4<false, true>;
+        position_kernel_ = &SGP4::FindPositionSGP4<false, false>;
+    }
 }
 
 #include <iomanip>
@@ -224,17 +297,285 @@ Eci SGP4::FindPosition(const DateTime& dt) const
 
 Eci SGP4::FindPosition(double tsince) const
 {
-    if (use_deep_space_)
+    return FindPosition(tsince, context_);
+}
+
+Eci SGP4::FindPosition(const DateTime& dt, Context& context) const
+{
+    return FindPosition((dt - elements_.Epoch()).TotalMinutes(), context);
+}
+
+Eci SGP4::FindPosition(double tsince, Context& context) const
+{
+    struct StateVector state;
+
+    Bind(context);
+
+    const Status status = Propagate(tsince, context, state);
+
+    if (status != STATUS_OK)
     {
-        return FindPositionSDP4(tsince);
+        ThrowStatus(status, elements_.Epoch().AddMinutes(tsince), state);
     }
-    else
+
+    return Eci(elements_.Epoch().AddMinutes(tsince),
+            Vector(state.x, state.y, state.z),
+            Vector(state.xdot, state.ydot, state.zdot));
+}
+
+Eci SGP4::FindPositionOnly(const DateTime& dt) const
+{
+    return FindPositionOnly((dt - elements_.Epoch()).TotalMinutes());
+}
+
+Eci SGP4::FindPositionOnly(double tsince) const
+{
+    return FindPositionOnly(tsince, context_);
+}
+
+Eci SGP4::FindPositionOnly(const DateTime& dt, Context& context) const
+{
+    return FindPositionOnly((dt - elements_.Epoch()).TotalMinutes(), context);
+}
+
+Eci SGP4::FindPositionOnly(double tsince, Context& context) const
+{
+    struct StateVector state;
+
+    Bind(context);
+
+    const Status status = PropagatePosition(tsince, context, state);
+
+    if (status != STATUS_OK)
+    {
+        ThrowStatus(status, elements_.Epoch().AddMinutes(tsince), state);
+    }
+
+    return Eci(elements_.Epoch().AddMinutes(tsince),
+            Vector(state.x, state.y, state.z));
+}
+
+SGP4::Status SGP4::TryFindPosition(double tsince, Eci& eci) const throw ()
+{
+    return TryFindPosition(tsince, context_, eci);
+}
+
+SGP4::Status SGP4::TryFindPosition(
+        double tsince,
+        Context& context,
+        Eci& eci) const throw ()
+{
+    struct StateVector state;
+
+    Bind(context);
+
+    const Status status = Propagate(tsince, context, state);
+
+    if (status == STATUS_OK || status == STATUS_DECAYED)
+    {
+        eci = Eci(elements_.Epoch().AddMinutes(tsince),
+                Vector(state.x, state.y, state.z),
+                Vector(state.xdot, state.ydot, state.zdot));
+    }
+
+    return status;
+}
+
+void SGP4::FindPositions(
+        const double* tsince,
+        const size_t n,
+        double* x,
+        double* y,
+        double* z,
+        double* vx,
+        double* vy,
+        double* vz,
+        Status* status) const
+{
+    const Kernel kernel = vx == NULL ? position_kernel_ : kernel_;
+    Context context;
+
+    Bind(context);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        struct StateVector state = StateVector();
+        const Status result = (this->*kernel)(tsince[i], context, state);
+
+        if (status != NULL)
+        {
+            status[i] = result;
+        }
+        else if (result != STATUS_OK)
+        {
+            ThrowStatus(result, elements_.Epoch().AddMinutes(tsince[i]), state);
+        }
+
+        x[i] = state.x;
+        y[i] = state.y;
+        z[i] = state.z;
+
+        if (vx != NULL)
+        {
+            vx[i] = state.xdot;
+            vy[i] = state.ydot;
+            vz[i] = state.zdot;
+        }
+    }
+}
+
+void SGP4::FindPositions(
+        const DateTime& start,
+        const TimeSpan& step,
+        const size_t n,
+        double* x,
+        double* y,
+        double* z,
+        double* vx,
+        double* vy,
+        double* vz,
+        Status* status) const
+{
+    FindPositions(TimeGrid(start, step, n), x, y, z, vx, vy, vz, status);
+}
+
+void SGP4::FindPositions(
+        const TimeGrid& grid,
+        double* x,
+        double* y,
+        double* z,
+        double* vx,
+        double* vy,
+        double* vz,
+        Status* status) const
+{
+    /*
+     * work in ticks relative to epoch so that the times do not accumulate
+     * rounding errors over long ranges
+     */
+    const long long offset = grid.Ticks(0) - elements_.Epoch().Ticks();
+    const long long step = grid.Step().Ticks();
+    const Kernel kernel = vx == NULL ? position_kernel_ : kernel_;
+    Context context;
+
+    Bind(context);
+
+    for (size_t i = 0; i < grid.Size(); i++)
+    {
+        const long long ticks = offset + static_cast<long long>(i) * step;
+        const double tsince = static_cast<double>(ticks) / TicksPerMinute;
+
+        struct StateVector state = StateVector();
+        const Status result = (this->*kernel)(tsince, context, state);
+
+        if (status != NULL)
+        {
+            status[i] = result;
+        }
+        else if (result != STATUS_OK)
+        {
+            ThrowStatus(result, elements_.Epoch().AddTicks(ticks), state);
+        }
+
+        x[i] = state.x;
+        y[i] = state.y;
+        z[i] = state.z;
+
+        if (vx != NULL)
+        {
+            vx[i] = state.xdot;
+            vy[i] = state.ydot;
+            vz[i] = state.zdot;
+        }
+    }
+}
+
+/**
+ * Throw the exception matching a propagation error
+ * @param[in] status the propagation result
+ * @param[in] dt the time propagated to
+ * @param[in] state the position and velocity at dt
+ * @exception SatelliteException
+ * @exception DecayedException
+ */
+void SGP4::ThrowStatus(
+        const Status status,
+        const DateTime& dt,
+        const struct StateVector& state)
+{
+    if (status == STATUS_DECAYED)
+    {
+        throw DecayedException(
+                dt,
+                Vector(state.x, state.y, state.z),
+                Vector(state.xdot, state.ydot, state.zdot));
+    }
+
+    throw SatelliteException(StatusString(status));
+}
+
+/**
+ * @param[in] status the propagation result
+ * @returns a description of the status
+ */
+const char* SGP4::StatusString(const Status status)
+{
+    switch (status)
     {
-        return FindPositionSGP4(tsince);
+        case STATUS_OK:
+            return "Ok";
+        case STATUS_DECAYED:
+            return "Error: Satellite decayed";
+        case STATUS_ECCENTRICITY_OUT_OF_RANGE:
+            return "Error: (e <= -0.001)";
+        case STATUS_PERTURBED_ECCENTRICITY_OUT_OF_RANGE:
+            return "Error: (elsq >= 1.0)";
+        case STATUS_MEAN_MOTION_NON_POSITIVE:
+            return "Error: (xn <= 0.0)";
+        case STATUS_SEMI_LATUS_RECTUM_NEGATIVE:
+            return "Error: (pl < 0.0)";
     }
+
+    return "Error: Unknown";
+}
+
+/**
+ * Reset a context if it was last used with a different model, or with
+ * this one before its elements were last set.
+ * @param[in,out] context the caller supplied context
+ */
+void SGP4::Bind(Context& context) const
+{
+    if (context.generation_ != generation_)
+    {
+        context.forward_.clear();
+        context.backward_.clear();
+        context.generation_ = generation_;
+        context.has_epw_ = false;
+    }
+}
+
+SGP4::Status SGP4::Propagate(
+        const double tsince,
+        Context& context,
+        struct StateVector& state) const
+{
+    return (this->*kernel_)(tsince, context, state);
+}
+
+SGP4::Status SGP4::PropagatePosition(
+        const double tsince,
+        Context& context,
+        struct StateVector& state) const
+{
+    return (this->*position_kernel_)(tsince, context, state);
 }
 
-Eci SGP4::FindPositionSDP4(double tsince) const
+template <SGP4::Resonance RESONANCE, bool VELOCITY>
+SGP4::Status SGP4::FindPositionSDP4(
+        const double tsince,
+        Context& context,
+        struct StateVector& state) const
 {
     /*
      * the final values
@@ -266,11 +607,12 @@ Eci SGP4::FindPositionSDP4(double tsince) const
     e = elements_.Eccentricity();
     xincl = elements_.Inclination();
 
-    DeepSpaceSecular(tsince, xmdf, omgadf, xnode, e, xincl, xn);
+    DeepSpaceSecular<RESONANCE>(tsince, context,
+            xmdf, omgadf, xnode, e, xincl, xn);
 
     if (xn <= 0.0)
     {
-        throw SatelliteException("Error: (xn <= 0.0)");
+        return STATUS_MEAN_MOTION_NON_POSITIVE;
     }
 
     a = pow(kXKE / xn, kTWOTHIRD) * tempa * tempa;
@@ -298,7 +640,7 @@ Eci SGP4::FindPositionSDP4(double tsince) const
      */
     if (e <= -0.001)
     {
-        throw SatelliteException("Error: (e <= -0.001)");
+        return STATUS_ECCENTRICITY_OUT_OF_RANGE;
     }
     else if (e < 1.0e-6)
     {
@@ -339,15 +681,18 @@ Eci SGP4::FindPositionSDP4(double tsince) const
     /*
      * using calculated values, find position and velocity
      */
-    return CalculateFinalPositionVelocity(tsince, e,
+    return CalculateFinalPositionVelocity<VELOCITY>(e,
             a, omega, xl, xnode,
             xincl, perturbed_xlcof, perturbed_aycof,
             perturbed_x3thm1, perturbed_x1mth2, perturbed_x7thm1,
-            perturbed_cosio, perturbed_sinio);
-
+            perturbed_cosio, perturbed_sinio, context, state);
 }
 
-Eci SGP4::FindPositionSGP4(double tsince) const
+template <bool SIMPLE_MODEL, bool VELOCITY>
+SGP4::Status SGP4::FindPositionSGP4(
+        const double tsince,
+        Context& context,
+        struct StateVector& state) const
 {
     /*
      * the final values
@@ -379,7 +724,7 @@ Eci SGP4::FindPositionSGP4(double tsince) const
     omega = omgadf;
     double xmp = xmdf;
 
-    if (!use_simple_model_)
+    if (!SIMPLE_MODEL)
     {
         const double delomg = nearspace_consts_.omgcof * tsince;
         const double delm = nearspace_consts_.xmcof
@@ -410,7 +755,7 @@ Eci SGP4::FindPositionSGP4(double tsince) const
      */
     if (e <= -0.001)
     {
-        throw SatelliteException("Error: (e <= -0.001)");
+        return STATUS_ECCENTRICITY_OUT_OF_RANGE;
     }
     else if (e < 1.0e-6)
     {
@@ -425,16 +770,14 @@ Eci SGP4::FindPositionSGP4(double tsince) const
      * using calculated values, find position and velocity
      * we can pass in constants from Initialise() as these dont change
      */
-    return CalculateFinalPositionVelocity(tsince, e,
+    return CalculateFinalPositionVelocity<VELOCITY>(e,
             a, omega, xl, xnode,
             xincl, common_consts_.xlcof, common_consts_.aycof,
             common_consts_.x3thm1, common_consts_.x1mth2, common_consts_.x7thm1,
-            common_consts_.cosio, common_consts_.sinio);
-
+            common_consts_.cosio, common_consts_.sinio, context, state);
 }
 
 /**
- * @param[in] tsince
  * @param[in] e
  * @param[in] a
  * @param[in] omega
@@ -448,10 +791,14 @@ Eci SGP4::FindPositionSGP4(double tsince) const
  * @param[in] x7thm1
  * @param[in] cosio
  * @param[in] sinio
- * @returns Eci result
+ * @param[in,out] context the previous solution of keplers equation, when
+ * warm starting
+ * @param[out] state the resulting position and velocity, the velocity is
+ * zero unless VELOCITY is set
+ * @returns the propagation result
  */
-Eci SGP4::CalculateFinalPositionVelocity(
-        const double tsince,
+template <bool VELOCITY>
+SGP4::Status SGP4::CalculateFinalPositionVelocity(
         const double e,
         const double a,
         const double omega,
@@ -464,10 +811,11 @@ Eci SGP4::CalculateFinalPositionVelocity(
         const double x1mth2,
         const double x7thm1,
         const double cosio,
-        const double sinio) const
+        const double sinio,
+        Context& context,
+        struct StateVector& state) const
 {
     const double beta2 = 1.0 - e * e;
-    const double xn = kXKE / pow(a, 1.5);
     /*
      * long period periodics
      */
@@ -481,7 +829,7 @@ Eci SGP4::CalculateFinalPositionVelocity(
 
     if (elsq >= 1.0)
     {
-        throw SatelliteException("Error: (elsq >= 1.0)");
+        return STATUS_PERTURBED_ECCENTRICITY_OUT_OF_RANGE;
     }
 
     /*
@@ -495,6 +843,26 @@ Eci SGP4::CalculateFinalPositionVelocity(
     const double capu = fmod(xlt - xnode, kTWOPI);
     double epw = capu;
 
+    if (context.warm_start_ && context.has_epw_)
+    {
+        const double step = Util::WrapNegPosPI(capu - context.capu_);
+        const double gap = 1.0 - sqrt(elsq);
+
+        if (fabs(step) < 0.1 * gap * gap)
+        {
+            /*
+             * predict the solution from the last one and the derivative of
+             * keplers equation there. the error is second order in the
+             * step, so for steps below 0.1 (1 - e)^2 the loop below
+             * converges after one correction. the guess is made relative
+             * to capu, as capu may have wrapped by 2pi since the last
+             * solution
+             */
+            epw = capu + (context.epw_ - context.capu_)
+                + step * context.ecose_ / (1.0 - context.ecose_);
+        }
+    }
+
     double sinepw = 0.0;
     double cosepw = 0.0;
     double ecose = 0.0;
@@ -509,8 +877,7 @@ Eci SGP4::CalculateFinalPositionVelocity(
 
     for (int i = 0; i < 10 && kepler_running; i++)
     {
-        sinepw = sin(epw);
-        cosepw = cos(epw);
+        Util::SinCos(epw, sinepw, cosepw);
         ecose = axn * cosepw + ayn * sinepw;
         esine = axn * sinepw - ayn * cosepw;
 
@@ -554,6 +921,14 @@ Eci SGP4::CalculateFinalPositionVelocity(
             epw += delta_epw;
         }
     }
+
+    if (context.warm_start_)
+    {
+        context.has_epw_ = true;
+        context.capu_ = capu;
+        context.epw_ = epw;
+        context.ecose_ = ecose;
+    }
     /*
      * short period preliminary quantities
      */
@@ -562,13 +937,11 @@ Eci SGP4::CalculateFinalPositionVelocity(
 
     if (pl < 0.0)
     {
-        throw SatelliteException("Error: (pl < 0.0)");
+        return STATUS_SEMI_LATUS_RECTUM_NEGATIVE;
     }
 
     const double r = a * (1.0 - ecose);
     const double temp31 = 1.0 / r;
-    const double rdot = kXKE * sqrt(a) * esine * temp31;
-    const double rfdot = kXKE * sqrt(pl) * temp31;
     const double temp32 = a * temp31;
     const double betal = sqrt(temp21);
     const double temp33 = 1.0 / (1.0 + betal);
@@ -590,47 +963,61 @@ Eci SGP4::CalculateFinalPositionVelocity(
     const double uk = u - 0.25 * temp43 * x7thm1 * sin2u;
     const double xnodek = xnode + 1.5 * temp43 * cosio * sin2u;
     const double xinck = xincl + 1.5 * temp43 * cosio * sinio * cos2u;
-    const double rdotk = rdot - xn * temp42 * x1mth2 * sin2u;
-    const double rfdotk = rfdot + xn * temp42 * (x1mth2 * cos2u + 1.5 * x3thm1);
 
     /*
      * orientation vectors
      */
-    const double sinuk = sin(uk);
-    const double cosuk = cos(uk);
-    const double sinik = sin(xinck);
-    const double cosik = cos(xinck);
-    const double sinnok = sin(xnodek);
-    const double cosnok = cos(xnodek);
+    double sinuk;
+    double cosuk;
+    double sinik;
+    double cosik;
+    double sinnok;
+    double cosnok;
+    Util::SinCos(uk, sinuk, cosuk);
+    Util::SinCos(xinck, sinik, cosik);
+    Util::SinCos(xnodek, sinnok, cosnok);
     const double xmx = -sinnok * cosik;
     const double xmy = cosnok * cosik;
     const double ux = xmx * sinuk + cosnok * cosuk;
     const double uy = xmy * sinuk + sinnok * cosuk;
     const double uz = sinik * sinuk;
-    const double vx = xmx * cosuk - cosnok * sinuk;
-    const double vy = xmy * cosuk - sinnok * sinuk;
-    const double vz = sinik * cosuk;
     /*
-     * position and velocity
+     * position
      */
-    const double x = rk * ux * kXKMPER;
-    const double y = rk * uy * kXKMPER;
-    const double z = rk * uz * kXKMPER;
-    Vector position(x, y, z);
-    const double xdot = (rdotk * ux + rfdotk * vx) * kXKMPER / 60.0;
-    const double ydot = (rdotk * uy + rfdotk * vy) * kXKMPER / 60.0;
-    const double zdot = (rdotk * uz + rfdotk * vz) * kXKMPER / 60.0;
-    Vector velocity(xdot, ydot, zdot);
+    state.x = rk * ux * kXKMPER;
+    state.y = rk * uy * kXKMPER;
+    state.z = rk * uz * kXKMPER;
+
+    if (VELOCITY)
+    {
+        const double xn = kXKE / pow(a, 1.5);
+        const double rdot = kXKE * sqrt(a) * esine * temp31;
+        const double rfdot = kXKE * sqrt(pl) * temp31;
+        const double rdotk = rdot - xn * temp42 * x1mth2 * sin2u;
+        const double rfdotk = rfdot + xn * temp42 * (x1mth2 * cos2u + 1.5 * x3thm1);
+        const double vx = xmx * cosuk - cosnok * sinuk;
+        const double vy = xmy * cosuk - sinnok * sinuk;
+        const double vz = sinik * cosuk;
+        /*
+         * velocity
+         */
+        state.xdot = (rdotk * ux + rfdotk * vx) * kXKMPER / 60.0;
+        state.ydot = (rdotk * uy + rfdotk * vy) * kXKMPER / 60.0;
+        state.zdot = (rdotk * uz + rfdotk * vz) * kXKMPER / 60.0;
+    }
+    else
+    {
+        state.xdot = 0.0;
+        state.ydot = 0.0;
+        state.zdot = 0.0;
+    }
 
     if (rk < 1.0)
     {
-        throw DecayedException(
-                elements_.Epoch().AddMinutes(tsince),
-                position,
-                velocity);
+        return STATUS_DECAYED;
     }
 
-    return Eci(elements_.Epoch().AddMinutes(tsince), position, velocity);
+    return STATUS_OK;
 }
 
 /**
@@ -1063,13 +1450,22 @@ void SGP4::DeepSpaceInitialise(
          * initialise integrator
          */
         integrator_consts_.xfact = bfact - elements_.RecoveredMeanMotion();
-        integrator_params_.atime = 0.0;
-        integrator_params_.xni = elements_.RecoveredMeanMotion();
-        integrator_params_.xli = integrator_consts_.xlamo;
+
+        struct IntegratorParams params = Empty_IntegratorParams;
+        params.atime = 0.0;
+        params.xni = elements_.RecoveredMeanMotion();
+        params.xli = integrator_consts_.xlamo;
         /*
          * precompute dot terms for epoch
          */
-        DeepSpaceCalcDotTerms(integrator_consts_.values_0);
+        if (deepspace_consts_.synchronous_flag)
+        {
+            DeepSpaceCalcDotTerms<true>(params, integrator_consts_.values_0);
+        }
+        else
+        {
+            DeepSpaceCalcDotTerms<false>(params, integrator_consts_.values_0);
+        }
     }
 }
 
@@ -1193,8 +1589,9 @@ void SGP4::DeepSpacePeriodics(
      * if (xinc >= 0.2)
      * (moved from start of function)
      */
-    const double sinis = sin(xinc);
-    const double cosis = cos(xinc);
+    double sinis;
+    double cosis;
+    Util::SinCos(xinc, sinis, cosis);
 
     if (xinc >= 0.2)
     {
@@ -1212,8 +1609,9 @@ void SGP4::DeepSpacePeriodics(
         /*
          * apply periodics with lyddane modification
          */
-        const double sinok = sin(xnodes);
-        const double cosok = cos(xnodes);
+        double sinok;
+        double cosok;
+        Util::SinCos(xnodes, sinok, cosok);
         double alfdp = sinis * sinok;
         double betdp = sinis * cosok;
         const double dalf = ph * cosok + pinc * cosis * sinok;
@@ -1264,6 +1662,7 @@ void SGP4::DeepSpacePeriodics(
 /*
  * Deep space secular effects
  * @param[in]     tsince
+ * @param[in,out] context the integrator state
  * @param[in,out] xll
  * @param[in,out] omgasm
  * @param[in,out] xnodes
@@ -1271,8 +1670,10 @@ void SGP4::DeepSpacePeriodics(
  * @param[in,out] xinc
  * @param[in,out] xn
  */
+template <SGP4::Resonance RESONANCE>
 void SGP4::DeepSpaceSecular(
         const double tsince,
+        Context& context,
         double& xll,
         double& omgasm,
         double& xnodes,
@@ -1280,88 +1681,35 @@ void SGP4::DeepSpaceSecular(
         double& xinc,
         double& xn) const
 {
-    static const double STEP = 720.0;
-    static const double STEP2 = 259200.0;
-
     xll += deepspace_consts_.ssl * tsince;
     omgasm += deepspace_consts_.ssg * tsince;
     xnodes += deepspace_consts_.ssh * tsince;
     em += deepspace_consts_.sse * tsince;
     xinc += deepspace_consts_.ssi * tsince;
 
-    if (deepspace_consts_.resonance_flag)
+    if (RESONANCE != RESONANCE_NONE)
     {
         /*
-         * 1st condition (if tsince is less than one time step from epoch)
-         * 2nd condition (if integrator_params_.atime and
-         *     tsince are of opposite signs, so zero crossing required)
-         * 3rd condition (if tsince is closer to zero than 
-         *     integrator_params_.atime, only integrate away from zero)
-         */
-        if (fabs(tsince) < STEP ||
-                tsince * integrator_params_.atime <= 0.0 ||
-                fabs(tsince) < fabs(integrator_params_.atime))
-        {
-            /*
-             * restart from epoch
-             */
-            integrator_params_.atime = 0.0;
-            integrator_params_.xni = elements_.RecoveredMeanMotion();
-            integrator_params_.xli = integrator_consts_.xlamo;
-
-            /*
-             * restore precomputed values for epoch
-             */
-            integrator_params_.values_t = integrator_consts_.values_0;
-        }
-
-        double ft = tsince - integrator_params_.atime;
-
-        /*
-         * if time difference (ft) is greater than the time step (720.0)
-         * loop around until integrator_params_.atime is within one time step of
-         * tsince
+         * integrator state at the last whole step before tsince
          */
-        if (fabs(ft) >= STEP)
-        {
-            /*
-             * calculate step direction to allow integrator_params_.atime
-             * to catch up with tsince
-             */
-            double delt = -STEP;
-            if (ft >= 0.0)
-            {
-                delt = STEP;
-            }
+        const struct IntegratorParams& params
+            = DeepSpaceFindStep<RESONANCE == RESONANCE_SYNCHRONOUS>(
+                    tsince, context);
 
-            do
-            {
-                /*
-                 * integrate using current dot terms
-                 */
-                DeepSpaceIntegrator(delt, STEP2, integrator_params_.values_t);
-
-                /*
-                 * calculate dot terms for next integration
-                 */
-                DeepSpaceCalcDotTerms(integrator_params_.values_t);
-
-                ft = tsince - integrator_params_.atime;
-            } while (fabs(ft) >= STEP);
-        }
+        const double ft = tsince - params.atime;
 
         /*
          * integrator
          */
-        xn = integrator_params_.xni 
-            + integrator_params_.values_t.xndot * ft
-            + integrator_params_.values_t.xnddt * ft * ft * 0.5;
-        const double xl = integrator_params_.xli
-            + integrator_params_.values_t.xldot * ft
-            + integrator_params_.values_t.xndot * ft * ft * 0.5;
+        xn = params.xni 
+            + params.values_t.xndot * ft
+            + params.values_t.xnddt * ft * ft * 0.5;
+        const double xl = params.xli
+            + params.values_t.xldot * ft
+            + params.values_t.xndot * ft * ft * 0.5;
         const double temp = -xnodes + deepspace_consts_.gsto + tsince * kTHDT;
 
-        if (deepspace_consts_.synchronous_flag)
+        if (RESONANCE == RESONANCE_SYNCHRONOUS)
         {
             xll = xl + temp - omgasm;
         }
@@ -1372,11 +1720,112 @@ void SGP4::DeepSpaceSecular(
     }
 }
 
+/*
+ * Find the integrator state at the last whole time step between epoch and
+ * tsince. The integrator always steps away from epoch, so the state after
+ * n steps is the same whichever query first reached it and whichever
+ * earlier state it was integrated from. Every kCheckpointSteps'th state
+ * and the last state reached are kept in the context, and each query
+ * integrates on from the nearest of them before tsince.
+ * @param[in]     tsince
+ * @param[in,out] context the integrator state
+ * @returns the integrator state, valid until the context is next used
+ */
+template <bool SYNCHRONOUS>
+const struct SGP4::IntegratorParams& SGP4::DeepSpaceFindStep(
+        const double tsince,
+        Context& context) const
+{
+    static const double STEP = 720.0;
+    static const double STEP2 = 259200.0;
+
+    /*
+     * integrate forwards for positive tsince, backwards for negative
+     */
+    std::vector<struct IntegratorParams>& checkpoints
+        = tsince >= 0.0 ? context.forward_ : context.backward_;
+    struct IntegratorParams& last
+        = tsince >= 0.0 ? context.forward_last_ : context.backward_last_;
+    const double delt = tsince >= 0.0 ? STEP : -STEP;
+
+    if (checkpoints.empty())
+    {
+        /*
+         * start from epoch using the precomputed values
+         */
+        struct IntegratorParams params = Empty_IntegratorParams;
+        params.atime = 0.0;
+        params.xni = elements_.RecoveredMeanMotion();
+        params.xli = integrator_consts_.xlamo;
+        params.values_t = integrator_consts_.values_0;
+        checkpoints.push_back(params);
+        last = params;
+    }
+
+    const double distance = fabs(tsince);
+
+    if (!(distance <= DBL_MAX))
+    {
+        /*
+         * there is no step to reach for a time which is not finite, and
+         * the result is not finite either way
+         */
+        return checkpoints[0];
+    }
+
+    /*
+     * the state after n steps is wanted, where n is the largest with
+     * n * STEP <= |tsince|. the last state reached will do if it is not
+     * past that, unless a checkpoint is nearer
+     */
+    const double whole = floor(distance / (STEP * Context::kCheckpointSteps));
+    const size_t nearest = whole < static_cast<double>(checkpoints.size() - 1)
+        ? static_cast<size_t>(whole) : checkpoints.size() - 1;
+
+    if (fabs(last.atime) > distance
+            || fabs(last.atime) < fabs(checkpoints[nearest].atime))
+    {
+        last = checkpoints[nearest];
+    }
+
+    size_t n = static_cast<size_t>(fabs(last.atime) / STEP);
+
+    /*
+     * loop around until atime is within one time step of tsince
+     */
+    while (fabs(tsince - last.atime) >= STEP)
+    {
+        /*
+         * integrate using current dot terms
+         */
+        DeepSpaceIntegrator(last, delt, STEP2, last.values_t);
+
+        /*
+         * calculate dot terms for next integration
+         */
+        DeepSpaceCalcDotTerms<SYNCHRONOUS>(last, last.values_t);
+
+        n++;
+        if (n % Context::kCheckpointSteps == 0
+                && n / Context::kCheckpointSteps == checkpoints.size()
+                && checkpoints.size() < Context::kCheckpoints)
+        {
+            checkpoints.push_back(last);
+        }
+    }
+
+    return last;
+}
+
 /*
  * Calculate dot terms
+ * @param[in] params the integrator state
  * @param[in,out] the integrator values
  */
-void SGP4::DeepSpaceCalcDotTerms(struct IntegratorValues& values) const
+template <bool SYNCHRONOUS>
+void SGP4::DeepSpaceCalcDotTerms(
+        const struct IntegratorParams& params,
+        struct IntegratorValues& values) const
 {
     static const double G22 = 5.7686396;
     static const double G32 = 0.95240898;
@@ -1387,61 +1836,61 @@ void SGP4::DeepSpaceCalcDotTerms(struct IntegratorValues& values) const
     static const double FASX4 = 2.8843198;
     static const double FASX6 = 0.37448087;
 
-    if (deepspace_consts_.synchronous_flag)
+    if (SYNCHRONOUS)
     {
 
         values.xndot = deepspace_consts_.del1
-            * sin(integrator_params_.xli - FASX2)
+            * sin(params.xli - FASX2)
             + deepspace_consts_.del2
-            * sin(2.0 * (integrator_params_.xli - FASX4))
+            * sin(2.0 * (params.xli - FASX4))
             + deepspace_consts_.del3
-            * sin(3.0 * (integrator_params_.xli - FASX6));
+            * sin(3.0 * (params.xli - FASX6));
         values.xnddt = deepspace_consts_.del1
-            * cos(integrator_params_.xli - FASX2)
+            * cos(params.xli - FASX2)
             + 2.0 * deepspace_consts_.del2
-            * cos(2.0 * (integrator_params_.xli - FASX4))
+            * cos(2.0 * (params.xli - FASX4))
             + 3.0 * deepspace_consts_.del3
-            * cos(3.0 * (integrator_params_.xli - FASX6));
+            * cos(3.0 * (params.xli - FASX6));
     }
     else
     {
         const double xomi = elements_.ArgumentPerigee()
-            + common_consts_.omgdot * integrator_params_.atime;
+            + common_consts_.omgdot * params.atime;
         const double x2omi = xomi + xomi;
-        const double x2li = integrator_params_.xli + integrator_params_.xli;
+        const double x2li = params.xli + params.xli;
 
         values.xndot = deepspace_consts_.d2201
-            * sin(x2omi + integrator_params_.xli - G22)
+            * sin(x2omi + params.xli - G22)
             * + deepspace_consts_.d2211
-            * sin(integrator_params_.xli - G22)
+            * sin(params.xli - G22)
             + deepspace_consts_.d3210
-            * sin(xomi + integrator_params_.xli - G32)
+            * sin(xomi + params.xli - G32)
             + deepspace_consts_.d3222
-            * sin(-xomi + integrator_params_.xli - G32)
+            * sin(-xomi + params.xli - G32)
             + deepspace_consts_.d4410
             * sin(x2omi + x2li - G44)
             + deepspace_consts_.d4422
             * sin(x2li - G44)
             + deepspace_consts_.d5220
-            * sin(xomi + integrator_params_.xli - G52)
+            * sin(xomi + params.xli - G52)
             + deepspace_consts_.d5232
-            * sin(-xomi + integrator_params_.xli - G52)
+            * sin(-xomi + params.xli - G52)
             + deepspace_consts_.d5421
             * sin(xomi + x2li - G54)
             + deepspace_consts_.d5433
             * sin(-xomi + x2li - G54);
         values.xnddt = deepspace_consts_.d2201
-            * cos(x2omi + integrator_params_.xli - G22)
+            * cos(x2omi + params.xli - G22)
             + deepspace_consts_.d2211
-            * cos(integrator_params_.xli - G22)
+            * cos(params.xli - G22)
             + deepspace_consts_.d3210
-            * cos(xomi + integrator_params_.xli - G32)
+            * cos(xomi + params.xli - G32)
             + deepspace_consts_.d3222
-            * cos(-xomi + integrator_params_.xli - G32)
+            * cos(-xomi + params.xli - G32)
             + deepspace_consts_.d5220
-            * cos(xomi + integrator_params_.xli - G52)
+            * cos(xomi + params.xli - G52)
             + deepspace_consts_.d5232
-            * cos(-xomi + integrator_params_.xli - G52)
+            * cos(-xomi + params.xli - G52)
             + 2.0 * (deepspace_consts_.d4410 * cos(x2omi + x2li - G44)
             + deepspace_consts_.d4422
             * cos(x2li - G44)
@@ -1451,17 +1900,19 @@ void SGP4::DeepSpaceCalcDotTerms(struct IntegratorValues& values) const
             * cos(-xomi + x2li - G54));
     }
 
-    values.xldot = integrator_params_.xni + integrator_consts_.xfact;
+    values.xldot = params.xni + integrator_consts_.xfact;
     values.xnddt *= values.xldot;
 }
 
 /*
  * Deep space integrator for time period of delt
+ * @param[in,out] params the integrator state
  * @param[in] delt
  * @param[in] step2
  * @param[in] values
  */
 void SGP4::DeepSpaceIntegrator(
+        struct IntegratorParams& params,
         const double delt,
         const double step2,
         const struct IntegratorValues &values) const
@@ -1469,23 +1920,26 @@ void SGP4::DeepSpaceIntegrator(
     /*
      * integrator
      */
-    integrator_params_.xli += values.xldot * delt + values.xndot * step2;
-    integrator_params_.xni += values.xndot * delt + values.xnddt * step2;
+    params.xli += values.xldot * delt + values.xndot * step2;
+    params.xni += values.xndot * delt + values.xnddt * step2;
 
     /*
      * increment integrator time
      */
-    integrator_params_.atime += delt;
+    params.atime += delt;
 }
 
 void SGP4::Reset()
 {
     use_simple_model_ = false;
     use_deep_space_ = false;
+    kernel_ = &SGP4::FindPositionSGP4<false, true>;
+    position_kernel_ = &SGP4::FindPositionSGP4<false, false>;
 
     common_consts_     = Empty_CommonConstants;
     nearspace_consts_  = Empty_NearSpaceConstants;
     deepspace_consts_  = Empty_DeepSpaceConstants;
     integrator_consts_ = Empty_IntegratorConstants;
-    integrator_params_ = Empty_IntegratorParams;
+    context_ = Context();
+    generation_ = __atomic_add_fetch(&generations_, 1ULL, __ATOMIC_SEQ_CST);
 }
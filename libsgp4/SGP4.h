@@ -21,9 +21,13 @@
 #include "Tle.h"
 #include "OrbitalElements.h"
 #include "Eci.h"
+#include "TimeGrid.h"
 #include "SatelliteException.h"
 #include "DecayedException.h"
 
+#include <cstddef>
+#include <vector>
+
 /**
  * @mainpage
  *
@@ -35,6 +39,9 @@
  */
 class SGP4
 {
+    friend class SatelliteBatch;
+    friend class ModelSnapshot;
+
 public:
     SGP4(const Tle& tle)
         : elements_(tle)
@@ -42,14 +49,172 @@ public:
         Initialise();
     }
 
+    SGP4(const TleRecord& record)
+        : elements_(record)
+    {
+        Initialise();
+    }
+
+    SGP4(const OrbitalElements& elements)
+        : elements_(elements)
+    {
+        Initialise();
+    }
+
     virtual ~SGP4()
     {
     }
 
+    class Context;
+
+    /**
+     * Result of propagating to a particular time
+     */
+    enum Status
+    {
+        STATUS_OK = 0,
+        /** the satellite has decayed, position and velocity are valid */
+        STATUS_DECAYED,
+        /** e <= -0.001 after applying secular effects */
+        STATUS_ECCENTRICITY_OUT_OF_RANGE,
+        /** elsq >= 1.0 after applying long period periodics */
+        STATUS_PERTURBED_ECCENTRICITY_OUT_OF_RANGE,
+        /** xn <= 0.0 after applying deep space secular effects */
+        STATUS_MEAN_MOTION_NON_POSITIVE,
+        /** pl < 0.0 */
+        STATUS_SEMI_LATUS_RECTUM_NEGATIVE
+    };
+
     void SetTle(const Tle& tle);
+    void SetTle(const TleRecord& record);
+
+    /**
+     * @returns the elements being propagated
+     */
+    const OrbitalElements& Elements() const
+    {
+        return elements_;
+    }
+
     Eci FindPosition(double tsince) const;
     Eci FindPosition(const DateTime& date) const;
 
+    /**
+     * Reentrant versions of FindPosition(). The deep space integrator state
+     * is kept in the caller supplied context rather than in this object, so
+     * one SGP4 can be shared between threads as long as each thread uses
+     * its own Context.
+     * @param[in] tsince time since epoch in minutes
+     * @param[in,out] context the integrator state
+     * @returns the position and velocity
+     */
+    Eci FindPosition(double tsince, Context& context) const;
+    Eci FindPosition(const DateTime& date, Context& context) const;
+
+    /**
+     * Versions of FindPosition() which only calculate the position, for
+     * when the velocity is not needed. The velocity of the result is zero.
+     * @param[in] tsince time since epoch in minutes
+     * @param[in,out] context the integrator state
+     * @returns the position
+     */
+    Eci FindPositionOnly(double tsince) const;
+    Eci FindPositionOnly(const DateTime& date) const;
+    Eci FindPositionOnly(double tsince, Context& context) const;
+    Eci FindPositionOnly(const DateTime& date, Context& context) const;
+
+    /**
+     * Non throwing versions of FindPosition(). eci is only updated when the
+     * result is STATUS_OK or STATUS_DECAYED.
+     * @param[in] tsince time since epoch in minutes
+     * @param[in,out] context the integrator state
+     * @param[out] eci the position and velocity
+     * @returns the propagation result
+     */
+    Status TryFindPosition(double tsince, Eci& eci) const throw ();
+    Status TryFindPosition(
+            double tsince,
+            Context& context,
+            Eci& eci) const throw ();
+
+    /**
+     * @param[in] status the propagation result
+     * @returns a description of the status
+     */
+    static const char* StatusString(const Status status);
+
+    /**
+     * Propagate to a series of times, writing the results into caller owned
+     * structure-of-arrays buffers. Each buffer must hold n values. Uses its
+     * own integrator state, so is safe to call from multiple threads.
+     * @param[in] tsince times since epoch in minutes
+     * @param[in] n the number of times
+     * @param[out] x position x in km
+     * @param[out] y position y in km
+     * @param[out] z position z in km
+     * @param[out] vx velocity x in km/s
+     * @param[out] vy velocity y in km/s
+     * @param[out] vz velocity z in km/s
+     * @param[out] status if not NULL the result for each time is written
+     * here instead of throwing an exception on error
+     *
+     * If vx, vy and vz are NULL only the positions are calculated.
+     */
+    void FindPositions(
+            const double* tsince,
+            const size_t n,
+            double* x,
+            double* y,
+            double* z,
+            double* vx,
+            double* vy,
+            double* vz,
+            Status* status = NULL) const;
+
+    /**
+     * Propagate to n evenly spaced times starting at start, writing the
+     * results into caller owned structure-of-arrays buffers. Uses its own
+     * integrator state, so is safe to call from multiple threads.
+     * @param[in] start the first time
+     * @param[in] step the interval between times
+     * @param[in] n the number of times
+     * @param[out] x position x in km
+     * @param[out] y position y in km
+     * @param[out] z position z in km
+     * @param[out] vx velocity x in km/s
+     * @param[out] vy velocity y in km/s
+     * @param[out] vz velocity z in km/s
+     * @param[out] status if not NULL the result for each time is written
+     * here instead of throwing an exception on error
+     *
+     * If vx, vy and vz are NULL only the positions are calculated.
+     */
+    void FindPositions(
+            const DateTime& start,
+            const TimeSpan& step,
+            const size_t n,
+            double* x,
+            double* y,
+            double* z,
+            double* vx,
+            double* vy,
+            double* vz,
+            Status* status = NULL) const;
+
+    /**
+     * Propagate to every time of a grid, as FindPositions() with a start,
+     * step and count. Each buffer must hold grid.Size() values.
+     */
+    void FindPositions(
+            const TimeGrid& grid,
+            double* x,
+            double* y,
+            double* z,
+            double* vx,
+            double* vy,
+            double* vz,
+            Status* status = NULL) const;
+
 private:
     struct CommonConstants
     {
@@ -177,6 +342,19 @@ private:
         struct IntegratorValues values_0;
     };
 
+    /*
+     * position (km) and velocity (km/s) as produced by the propagator
+     */
+    struct StateVector
+    {
+        double x;
+        double y;
+        double z;
+        double xdot;
+        double ydot;
+        double zdot;
+    };
+
     struct IntegratorParams
     {
         /*
@@ -191,11 +369,139 @@ private:
         struct IntegratorValues values_t;
     };
     
+public:
+    /**
+     * @brief Deep space integrator state for the reentrant FindPosition().
+     *
+     * Holds the resonance integrator state at every kCheckpointSteps'th
+     * integrator step reached so far, built lazily in each direction from
+     * epoch, and the last state reached in each direction. A query resumes
+     * from whichever of these is nearest before it instead of integrating
+     * from epoch again, so times which advance in small steps integrate
+     * each step once. At most kCheckpoints states are kept in each
+     * direction, beyond them queries integrate on from the last one, so
+     * the memory used is bounded however far from epoch the queries are.
+     *
+     * A default constructed Context is ready to use. It may be reused for
+     * any number of calls, it is reset automatically if used with a
+     * different model, or with the same model after SetTle(). Copies of a
+     * model count as the same model.
+     */
+    class Context
+    {
+    public:
+        /**
+         * @param[in] warm_start solve keplers equation starting from the
+         * previous solution when it is close enough, for times which
+         * advance in small steps. positions then differ from those found
+         * with a default Context by up to about 3e-7 km, as the solution
+         * converges to the same tolerance from a different guess
+         */
+        Context(const bool warm_start = false)
+            : forward_last_(),
+            backward_last_(),
+            generation_(0),
+            warm_start_(warm_start),
+            has_epw_(false),
+            capu_(0.0),
+            epw_(0.0),
+            ecose_(0.0)
+        {
+        }
+
+        /**
+         * The number of integrator steps between kept states.
+         */
+        static const size_t kCheckpointSteps = 16;
+
+        /**
+         * The number of states kept in each direction, about 89 years of
+         * steps.
+         */
+        static const size_t kCheckpoints = 4096;
+
+    private:
+        friend class SGP4;
+
+        /*
+         * integrator states after 0, kCheckpointSteps, 2 kCheckpointSteps...
+         * steps forward and backward in time from epoch
+         */
+        std::vector<struct IntegratorParams> forward_;
+        std::vector<struct IntegratorParams> backward_;
+        /*
+         * the last state reached in each direction, valid once the
+         * direction has a checkpoint
+         */
+        struct IntegratorParams forward_last_;
+        struct IntegratorParams backward_last_;
+        /*
+         * generation of the model the states belong to, zero if none
+         */
+        unsigned long long generation_;
+        /*
+         * the last solution of keplers equation, kept when warm starting
+         */
+        bool warm_start_;
+        bool has_epw_;
+        double capu_;
+        double epw_;
+        double ecose_;
+    };
+
+private:
+    /*
+     * the kinds of deep space resonance
+     */
+    enum Resonance
+    {
+        RESONANCE_NONE,
+        RESONANCE_12_HOUR,
+        RESONANCE_SYNCHRONOUS
+    };
+
+    /*
+     * a propagator specialised for one kind of orbit
+     */
+    typedef Status (SGP4::*Kernel)(
+            const double tsince,
+            Context& context,
+            struct StateVector& state) const;
+
+    SGP4(const OrbitalElements& elements,
+            const struct CommonConstants& common_consts,
+            const struct NearSpaceConstants& nearspace_consts,
+            const struct DeepSpaceConstants& deepspace_consts,
+            const struct IntegratorConstants& integrator_consts,
+            const bool use_simple_model,
+            const bool use_deep_space);
     void Initialise();
-    Eci FindPositionSDP4(const double tsince) const;
-    Eci FindPositionSGP4(double tsince) const;
-    Eci CalculateFinalPositionVelocity(
+    void SelectKernels();
+    void Bind(Context& context) const;
+    static void ThrowStatus(
+            const Status status,
+            const DateTime& dt,
+            const struct StateVector& state);
+    Status Propagate(
+            const double tsince,
+            Context& context,
+            struct StateVector& state) const;
+    Status PropagatePosition(
             const double tsince,
+            Context& context,
+            struct StateVector& state) const;
+    template <Resonance RESONANCE, bool VELOCITY>
+    Status FindPositionSDP4(
+            const double tsince,
+            Context& context,
+            struct StateVector& state) const;
+    template <bool SIMPLE_MODEL, bool VELOCITY>
+    Status FindPositionSGP4(
+            const double tsince,
+            Context& context,
+            struct StateVector& state) const;
+    template <bool VELOCITY>
+    Status CalculateFinalPositionVelocity(
             const double e,
             const double a,
             const double omega,
@@ -208,7 +514,9 @@ private:
             const double x1mth2,
             const double x7thm1,
             const double cosio,
-            const double sinio) const;
+            const double sinio,
+            Context& context,
+            struct StateVector& state) const;
     void DeepSpaceInitialise(
             const double eosq,
             const double sinio,
@@ -233,16 +541,26 @@ private:
             double& omgasm,
             double& xnodes,
             double& xll) const;
+    template <Resonance RESONANCE>
     void DeepSpaceSecular(
             const double tsince,
+            Context& context,
             double& xll,
             double& omgasm,
             double& xnodes,
             double& em,
             double& xinc,
             double& xn) const;
-    void DeepSpaceCalcDotTerms(struct IntegratorValues& values) const;
+    template <bool SYNCHRONOUS>
+    const struct IntegratorParams& DeepSpaceFindStep(
+            const double tsince,
+            Context& context) const;
+    template <bool SYNCHRONOUS>
+    void DeepSpaceCalcDotTerms(
+            const struct IntegratorParams& params,
+            struct IntegratorValues& values) const;
     void DeepSpaceIntegrator(
+            struct IntegratorParams& params,
             const double delt,
             const double step2,
             const struct IntegratorValues& values) const;
@@ -254,6 +572,13 @@ private:
     bool use_simple_model_;
     bool use_deep_space_;
 
+    /*
+     * the propagators selected for this orbit by Initialise(), with and
+     * without velocity
+     */
+    Kernel kernel_;
+    Kernel position_kernel_;
+
     /*
      * the constants used
      */
@@ -261,7 +586,14 @@ private:
     struct NearSpaceConstants nearspace_consts_;
     struct DeepSpaceConstants deepspace_consts_;
     struct IntegratorConstants integrator_consts_;
-    mutable struct IntegratorParams integrator_params_;
+    mutable Context context_;
+
+    /*
+     * identifies the constants above, a new value is taken from
+     * generations_ each time they are calculated or restored
+     */
+    unsigned long long generation_;
+    static unsigned long long generations_;
 
     /*
      * the orbit data
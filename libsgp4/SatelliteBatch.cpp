@@ -0,0 +1,617 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SatelliteBatch.h"
+
+#include "Globals.h"
+#include "KeplerSolver.h"
+#include "Util.h"
+#include "Vector.h"
+
+#include <cmath>
+
+namespace
+{
+    /*
+     * the library calls of the lane kernel. with SGP4_FAST_MATH they are
+     * replaced by arithmetic, so that the loops over lanes vectorise,
+     * otherwise they match SGP4 exactly
+     */
+    inline double Cosine(const double x)
+    {
+#ifdef SGP4_FAST_MATH
+        double sinx;
+        double cosx;
+        Util::SinCosPolynomial(x, sinx, cosx);
+        return cosx;
+#else
+        return cos(x);
+#endif
+    }
+
+    inline double Sine(const double x)
+    {
+#ifdef SGP4_FAST_MATH
+        double sinx;
+        double cosx;
+        Util::SinCosPolynomial(x, sinx, cosx);
+        return sinx;
+#else
+        return sin(x);
+#endif
+    }
+
+    inline double Cube(const double x)
+    {
+#ifdef SGP4_FAST_MATH
+        return x * x * x;
+#else
+        return pow(x, 3.0);
+#endif
+    }
+
+    template <typename T>
+    inline T PowOneAndHalf(const T x)
+    {
+#ifdef SGP4_FAST_MATH
+        return x * std::sqrt(x);
+#else
+        return std::pow(x, T(1.5));
+#endif
+    }
+
+    template <typename T>
+    inline T Remainder(const T x, const T y)
+    {
+#ifdef SGP4_FAST_MATH
+        const T q = x / y;
+        return x - y * (q < T(0.0) ? std::ceil(q) : std::floor(q));
+#else
+        return std::fmod(x, y);
+#endif
+    }
+
+    template
+    <typename T>
+    void PadColumn(std::vector<T>& column, const size_t size)
+    {
+        if (!column.empty())
+        {
+            column.resize(size, column.back());
+        }
+    }
+}
+
+/*
+ * the parts of the lane kernel which depend on the precision
+ */
+template <>
+struct SatelliteBatch::LaneTraits<double>
+{
+    static const size_t kLanes = kVectorBytes / sizeof(double);
+
+    static double Angle(const double angle)
+    {
+        return angle;
+    }
+};
+
+template <>
+struct SatelliteBatch::LaneTraits<float>
+{
+    static const size_t kLanes = kVectorBytes / sizeof(float);
+
+    /*
+     * reduce to within one revolution before rounding, so that the angle
+     * keeps its precision however long since epoch
+     */
+    static float Angle(const double angle)
+    {
+        return static_cast<float>(Remainder(angle, kTWOPI));
+    }
+};
+
+SatelliteBatch::SatelliteBatch(const std::vector<Tle>& tles)
+    : size_(tles.size())
+{
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        SGP4 model(tles[i]);
+
+        if (model.use_deep_space_)
+        {
+            deep_.push_back(model);
+            deep_index_.push_back(i);
+        }
+        else
+        {
+            Add(model);
+            near_index_.push_back(i);
+        }
+    }
+
+    /*
+     * pad the columns to a whole number of lane groups by repeating the
+     * last satellite, the padded results are never read. single precision
+     * has the most lanes per group, so the padding suits either precision
+     */
+    const size_t lanes = LaneTraits<float>::kLanes;
+    const size_t padded = (near_index_.size() + lanes - 1) / lanes * lanes;
+
+    PadColumn(epoch_, padded);
+    PadColumn(xmo_, padded);
+    PadColumn(omegao_, padded);
+    PadColumn(xnodeo_, padded);
+    PadColumn(eo_, padded);
+    PadColumn(xincl_, padded);
+    PadColumn(bstar_, padded);
+    PadColumn(aodp_, padded);
+    PadColumn(xnodp_, padded);
+    PadColumn(cosio_, padded);
+    PadColumn(sinio_, padded);
+    PadColumn(eta_, padded);
+    PadColumn(t2cof_, padded);
+    PadColumn(x1mth2_, padded);
+    PadColumn(x3thm1_, padded);
+    PadColumn(x7thm1_, padded);
+    PadColumn(aycof_, padded);
+    PadColumn(xlcof_, padded);
+    PadColumn(xnodcf_, padded);
+    PadColumn(c1_, padded);
+    PadColumn(c4_, padded);
+    PadColumn(omgdot_, padded);
+    PadColumn(xnodot_, padded);
+    PadColumn(xmdot_, padded);
+    PadColumn(c5_, padded);
+    PadColumn(omgcof_, padded);
+    PadColumn(xmcof_, padded);
+    PadColumn(delmo_, padded);
+    PadColumn(sinmo_, padded);
+    PadColumn(d2_, padded);
+    PadColumn(d3_, padded);
+    PadColumn(d4_, padded);
+    PadColumn(t3cof_, padded);
+    PadColumn(t4cof_, padded);
+    PadColumn(t5cof_, padded);
+}
+
+void SatelliteBatch::Add(const SGP4& model)
+{
+    const OrbitalElements& elements = model.elements_;
+    const SGP4::CommonConstants& common = model.common_consts_;
+    const SGP4::NearSpaceConstants& nearspace = model.nearspace_consts_;
+
+    epoch_.push_back(elements.Epoch().Ticks());
+    xmo_.push_back(elements.MeanAnomoly());
+    omegao_.push_back(elements.ArgumentPerigee());
+    xnodeo_.push_back(elements.AscendingNode());
+    eo_.push_back(elements.Eccentricity());
+    xincl_.push_back(elements.Inclination());
+    bstar_.push_back(elements.BStar());
+    aodp_.push_back(elements.RecoveredSemiMajorAxis());
+    xnodp_.push_back(elements.RecoveredMeanMotion());
+
+    cosio_.push_back(common.cosio);
+    sinio_.push_back(common.sinio);
+    eta_.push_back(common.eta);
+    t2cof_.push_back(common.t2cof);
+    x1mth2_.push_back(common.x1mth2);
+    x3thm1_.push_back(common.x3thm1);
+    x7thm1_.push_back(common.x7thm1);
+    aycof_.push_back(common.aycof);
+    xlcof_.push_back(common.xlcof);
+    xnodcf_.push_back(common.xnodcf);
+    c1_.push_back(common.c1);
+    c4_.push_back(common.c4);
+    omgdot_.push_back(common.omgdot);
+    xnodot_.push_back(common.xnodot);
+    xmdot_.push_back(common.xmdot);
+
+    /*
+     * the simple model drops the c5, delta omega and delta m terms. zeroing
+     * their coefficients gives the same result without a branch per lane
+     */
+    if (model.use_simple_model_)
+    {
+        c5_.push_back(0.0);
+        omgcof_.push_back(0.0);
+        xmcof_.push_back(0.0);
+    }
+    else
+    {
+        c5_.push_back(nearspace.c5);
+        omgcof_.push_back(nearspace.omgcof);
+        xmcof_.push_back(nearspace.xmcof);
+    }
+    delmo_.push_back(nearspace.delmo);
+    sinmo_.push_back(nearspace.sinmo);
+    d2_.push_back(nearspace.d2);
+    d3_.push_back(nearspace.d3);
+    d4_.push_back(nearspace.d4);
+    t3cof_.push_back(nearspace.t3cof);
+    t4cof_.push_back(nearspace.t4cof);
+    t5cof_.push_back(nearspace.t5cof);
+}
+
+void SatelliteBatch::FindPositions(
+        const DateTime& dt,
+        double* x,
+        double* y,
+        double* z,
+        double* vx,
+        double* vy,
+        double* vz,
+        SGP4::Status* status) const
+{
+    FindPositionsAll(dt, x, y, z, vx, vy, vz, status);
+}
+
+void SatelliteBatch::FindPositions(
+        const DateTime& dt,
+        float* x,
+        float* y,
+        float* z,
+        float* vx,
+        float* vy,
+        float* vz,
+        SGP4::Status* status) const
+{
+    FindPositionsAll(dt, x, y, z, vx, vy, vz, status);
+}
+
+/**
+ * Propagate every satellite to dt, the near earth satellites in groups
+ * using arithmetic of type T, the deep space satellites using SGP4.
+ */
+template <typename T>
+void SatelliteBatch::FindPositionsAll(
+        const DateTime& dt,
+        T* x,
+        T* y,
+        T* z,
+        T* vx,
+        T* vy,
+        T* vz,
+        SGP4::Status* status) const
+{
+    const size_t groups = epoch_.size() / LaneTraits<T>::kLanes;
+
+    for (size_t group = 0; group < groups; group++)
+    {
+        if (vx == NULL)
+        {
+            FindPositionsGroup<T, false>(group, dt.Ticks(),
+                    x, y, z, vx, vy, vz, status);
+        }
+        else
+        {
+            FindPositionsGroup<T, true>(group, dt.Ticks(),
+                    x, y, z, vx, vy, vz, status);
+        }
+    }
+
+    /*
+     * the batch may be used from several threads at once, so the deep
+     * space integrator state is kept here rather than in the models
+     */
+    SGP4::Context context;
+
+    for (size_t i = 0; i < deep_.size(); i++)
+    {
+        const size_t j = deep_index_[i];
+        const SGP4& model = deep_[i];
+        const double tsince = (dt - model.elements_.Epoch()).TotalMinutes();
+        SGP4::StateVector state = SGP4::StateVector();
+
+        model.Bind(context);
+
+        const SGP4::Status result = vx == NULL
+            ? model.PropagatePosition(tsince, context, state)
+            : model.Propagate(tsince, context, state);
+
+        if (status != NULL)
+        {
+            status[j] = result;
+        }
+        else if (result != SGP4::STATUS_OK)
+        {
+            SGP4::ThrowStatus(result,
+                    model.elements_.Epoch().AddMinutes(tsince), state);
+        }
+
+        x[j] = static_cast<T>(state.x);
+        y[j] = static_cast<T>(state.y);
+        z[j] = static_cast<T>(state.z);
+
+        if (vx != NULL)
+        {
+            vx[j] = static_cast<T>(state.xdot);
+            vy[j] = static_cast<T>(state.ydot);
+            vz[j] = static_cast<T>(state.zdot);
+        }
+    }
+}
+
+/**
+ * Evaluate FindPositionSGP4() and CalculateFinalPositionVelocity() for one
+ * group of LaneTraits<T>::kLanes satellites.
+ * @param[in] group the lane group
+ * @param[in] ticks the time to propagate to
+ * @param[out] x position x in km
+ * @param[out] y position y in km
+ * @param[out] z position z in km
+ * @param[out] vx velocity x in km/s
+ * @param[out] vy velocity y in km/s
+ * @param[out] vz velocity z in km/s
+ * @param[out] status the result for each satellite, or NULL to throw
+ *
+ * The secular terms are always evaluated in double precision, as they
+ * grow with time since epoch. The periodics, keplers equation and the
+ * position and velocity use T. The velocity is only calculated and written
+ * when VELOCITY is set.
+ *
+ * The loops over lanes have no branches. The values the errors are found
+ * from are kept, and the status of each lane is decided afterwards in the
+ * order FindPositionSGP4() checks them.
+ */
+template <typename T, bool VELOCITY>
+void SatelliteBatch::FindPositionsGroup(
+        const size_t group,
+        const long long ticks,
+        T* x,
+        T* y,
+        T* z,
+        T* vx,
+        T* vy,
+        T* vz,
+        SGP4::Status* status) const
+{
+    static const size_t kGroupLanes = LaneTraits<T>::kLanes;
+    const size_t base = group * kGroupLanes;
+
+    double tsince[kGroupLanes];
+    T a[kGroupLanes];
+    T xnode[kGroupLanes];
+    T xincl[kGroupLanes];
+    T eraw[kGroupLanes];
+    T elsq[kGroupLanes];
+    KeplerSolver::Group<T, kGroupLanes> kepler;
+
+    /*
+     * there is no vector conversion from 64 bit integers before AVX-512,
+     * so the times are found on their own
+     */
+    for (size_t l = 0; l < kGroupLanes; l++)
+    {
+        tsince[l] = static_cast<double>(ticks - epoch_[base + l])
+            / TicksPerMinute;
+    }
+
+    /*
+     * secular gravity and atmospheric drag, then the long period periodics
+     */
+    for (size_t l = 0; l < kGroupLanes; l++)
+    {
+        const size_t i = base + l;
+        const double t = tsince[l];
+        const double xmdf = xmo_[i] + xmdot_[i] * t;
+        const double omgadf = omegao_[i] + omgdot_[i] * t;
+        const double xnoddf = xnodeo_[i] + xnodot_[i] * t;
+        const double tsq = t * t;
+        const double tcube = tsq * t;
+        const double tfour = t * tcube;
+
+        const double xnoddp = xnoddf + xnodcf_[i] * tsq;
+        xnode[l] = LaneTraits<T>::Angle(xnoddp);
+        xincl[l] = static_cast<T>(xincl_[i]);
+
+        const double delomg = omgcof_[i] * t;
+        const double delm = xmcof_[i]
+            * (Cube(1.0 + eta_[i] * Cosine(xmdf)) * - delmo_[i]);
+        const double temp = delomg + delm;
+        const double xmp = xmdf + temp;
+
+        const double tempa = 1.0 - c1_[i] * t
+            - d2_[i] * tsq - d3_[i] * tcube - d4_[i] * tfour;
+        const double tempe = bstar_[i] * c4_[i] * t
+            + bstar_[i] * c5_[i] * (Sine(xmp) - sinmo_[i]);
+        const double templ = t2cof_[i] * tsq
+            + (t3cof_[i] * tcube + tfour * (t4cof_[i] + t * t5cof_[i]));
+
+        const T omega = LaneTraits<T>::Angle(omgadf - temp);
+        const T xl = LaneTraits<T>::Angle(
+                xmp + (omgadf - temp) + xnoddp + xnodp_[i] * templ);
+        a[l] = static_cast<T>(aodp_[i] * tempa * tempa);
+        eraw[l] = static_cast<T>(eo_[i] - tempe);
+
+        /*
+         * fix tolerance for error recognition
+         */
+        T e = eraw[l] < T(1.0e-6) ? T(1.0e-6) : eraw[l];
+        e = e > (T(1.0) - T(1.0e-6)) ? T(1.0) - T(1.0e-6) : e;
+
+        T sinomega;
+        T cosomega;
+        Util::SinCos(omega, sinomega, cosomega);
+
+        const T beta2 = T(1.0) - e * e;
+        kepler.axn[l] = e * cosomega;
+        const T temp11 = T(1.0) / (a[l] * beta2);
+        const T xll = temp11 * static_cast<T>(xlcof_[i]) * kepler.axn[l];
+        const T aynl = temp11 * static_cast<T>(aycof_[i]);
+        const T xlt = xl + xll;
+        kepler.ayn[l] = e * sinomega + aynl;
+        elsq[l] = kepler.axn[l] * kepler.axn[l]
+            + kepler.ayn[l] * kepler.ayn[l];
+
+        kepler.capu[l] = Remainder(xlt - xnode[l], T(kTWOPI));
+    }
+
+    /*
+     * solve keplers equation for all lanes with the same number of
+     * corrections
+     */
+    KeplerSolver::Solve(kepler);
+
+    /*
+     * short period periodics, orientation vectors, position and velocity
+     */
+    T pl[kGroupLanes];
+    T rk[kGroupLanes];
+    T rx[kGroupLanes];
+    T ry[kGroupLanes];
+    T rz[kGroupLanes];
+    T rxdot[kGroupLanes];
+    T rydot[kGroupLanes];
+    T rzdot[kGroupLanes];
+
+    for (size_t l = 0; l < kGroupLanes; l++)
+    {
+        const size_t i = base + l;
+        const T x1mth2 = static_cast<T>(x1mth2_[i]);
+        const T x3thm1 = static_cast<T>(x3thm1_[i]);
+        const T x7thm1 = static_cast<T>(x7thm1_[i]);
+        const T cosio = static_cast<T>(cosio_[i]);
+        const T sinio = static_cast<T>(sinio_[i]);
+
+        const T temp21 = T(1.0) - elsq[l];
+        pl[l] = a[l] * temp21;
+
+        const T r = a[l] * (T(1.0) - kepler.ecose[l]);
+        const T temp31 = T(1.0) / r;
+        const T temp32 = a[l] * temp31;
+        const T betal = std::sqrt(temp21);
+        const T temp33 = T(1.0) / (T(1.0) + betal);
+        const T cosu = temp32 * (kepler.cosepw[l] - kepler.axn[l]
+                + kepler.ayn[l] * kepler.esine[l] * temp33);
+        const T sinu = temp32 * (kepler.sinepw[l] - kepler.ayn[l]
+                - kepler.axn[l] * kepler.esine[l] * temp33);
+        const T u = Util::Atan2(sinu, cosu);
+        const T sin2u = T(2.0) * sinu * cosu;
+        const T cos2u = T(2.0) * cosu * cosu - T(1.0);
+
+        const T temp41 = T(1.0) / pl[l];
+        const T temp42 = T(kCK2) * temp41;
+        const T temp43 = temp42 * temp41;
+
+        rk[l] = r * (T(1.0) - T(1.5) * temp43 * betal * x3thm1)
+            + T(0.5) * temp42 * x1mth2 * cos2u;
+        const T uk = u - T(0.25) * temp43 * x7thm1 * sin2u;
+        const T xnodek = xnode[l] + T(1.5) * temp43 * cosio * sin2u;
+        const T xinck = xincl[l]
+            + T(1.5) * temp43 * cosio * sinio * cos2u;
+
+        T sinuk;
+        T cosuk;
+        T sinik;
+        T cosik;
+        T sinnok;
+        T cosnok;
+        Util::SinCos(uk, sinuk, cosuk);
+        Util::SinCos(xinck, sinik, cosik);
+        Util::SinCos(xnodek, sinnok, cosnok);
+        const T xmx = -sinnok * cosik;
+        const T xmy = cosnok * cosik;
+        const T ux = xmx * sinuk + cosnok * cosuk;
+        const T uy = xmy * sinuk + sinnok * cosuk;
+        const T uz = sinik * sinuk;
+
+        rx[l] = rk[l] * ux * T(kXKMPER);
+        ry[l] = rk[l] * uy * T(kXKMPER);
+        rz[l] = rk[l] * uz * T(kXKMPER);
+
+        if (VELOCITY)
+        {
+            const T xn = T(kXKE) / PowOneAndHalf(a[l]);
+            const T rdot = T(kXKE) * std::sqrt(a[l]) * kepler.esine[l]
+                * temp31;
+            const T rfdot = T(kXKE) * std::sqrt(pl[l]) * temp31;
+            const T rdotk = rdot - xn * temp42 * x1mth2 * sin2u;
+            const T rfdotk = rfdot
+                + xn * temp42 * (x1mth2 * cos2u + T(1.5) * x3thm1);
+            const T vx1 = xmx * cosuk - cosnok * sinuk;
+            const T vy1 = xmy * cosuk - sinnok * sinuk;
+            const T vz1 = sinik * cosuk;
+
+            rxdot[l] = (rdotk * ux + rfdotk * vx1) * T(kXKMPER) / T(60.0);
+            rydot[l] = (rdotk * uy + rfdotk * vy1) * T(kXKMPER) / T(60.0);
+            rzdot[l] = (rdotk * uz + rfdotk * vz1) * T(kXKMPER) / T(60.0);
+        }
+        else
+        {
+            rxdot[l] = T(0.0);
+            rydot[l] = T(0.0);
+            rzdot[l] = T(0.0);
+        }
+    }
+
+    /*
+     * scatter the real lanes back to their original index
+     */
+    for (size_t l = 0; l < kGroupLanes && base + l < near_index_.size(); l++)
+    {
+        const size_t j = near_index_[base + l];
+        SGP4::Status error = SGP4::STATUS_OK;
+
+        if (eraw[l] <= T(-0.001))
+        {
+            error = SGP4::STATUS_ECCENTRICITY_OUT_OF_RANGE;
+        }
+        else if (elsq[l] >= T(1.0))
+        {
+            error = SGP4::STATUS_PERTURBED_ECCENTRICITY_OUT_OF_RANGE;
+        }
+        else if (pl[l] < T(0.0))
+        {
+            error = SGP4::STATUS_SEMI_LATUS_RECTUM_NEGATIVE;
+        }
+        else if (rk[l] < T(1.0))
+        {
+            error = SGP4::STATUS_DECAYED;
+        }
+
+        if (status != NULL)
+        {
+            status[j] = error;
+        }
+        else if (error != SGP4::STATUS_OK)
+        {
+            SGP4::StateVector state;
+            state.x = rx[l];
+            state.y = ry[l];
+            state.z = rz[l];
+            state.xdot = rxdot[l];
+            state.ydot = rydot[l];
+            state.zdot = rzdot[l];
+
+            SGP4::ThrowStatus(error,
+                    DateTime(epoch_[base + l]).AddMinutes(tsince[l]),
+                    state);
+        }
+
+        x[j] = rx[l];
+        y[j] = ry[l];
+        z[j] = rz[l];
+
+        if (VELOCITY)
+        {
+            vx[j] = rxdot[l];
+            vy[j] = rydot[l];
+            vz[j] = rzdot[l];
+        }
+    }
+}
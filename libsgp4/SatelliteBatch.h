@@ -0,0 +1,212 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SATELLITEBATCH_H_
+#define SATELLITEBATCH_H_
+
+#include "Tle.h"
+#include "SGP4.h"
+#include "DateTime.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Propagates a catalog of satellites to a common time.
+ *
+ * The near earth constants of every satellite are packed column-wise and
+ * evaluated in groups of Lanes() satellites, so that each step of the SGP4
+ * model is a loop over adjacent values. Deep space satellites are
+ * propagated one at a time using SGP4.
+ *
+ * The loops only become vector instructions when built with SGP4_FAST_MATH
+ * (configure --enable-fast-math), which replaces the library calls in them
+ * with Util's polynomials, and are widened to AVX2 by --enable-avx2.
+ * Otherwise the batch is slower than SGP4, by about 30 to 40 percent in
+ * the benchmark (562 against 438 ns per position in double precision),
+ * so SGP4 should be preferred in that build. Either way the results agree
+ * with SGP4 to about 1e-8 km, as keplers equation is solved with
+ * KeplerSolver rather than SGP4's newton-raphson loop. The benchmark
+ * program times both builds against SGP4 and reports the difference.
+ *
+ * Positions may be found in single precision, which fits twice as many
+ * satellites in each vector at the cost of accuracy, so it is only faster
+ * in a vectorised build. The benchmark program reports the error against
+ * double precision.
+ */
+class SatelliteBatch
+{
+public:
+    /**
+     * @param[in] tles the satellites to propagate
+     * @exception SatelliteException if a satellite fails to initialise
+     */
+    SatelliteBatch(const std::vector<Tle>& tles);
+
+    virtual ~SatelliteBatch()
+    {
+    }
+
+    /**
+     * @returns the number of satellites
+     */
+    size_t Size() const
+    {
+        return size_;
+    }
+
+    /**
+     * @returns the number of satellites evaluated together in double
+     * precision, twice as many are evaluated together in single precision
+     */
+    static size_t Lanes()
+    {
+        return kLanes;
+    }
+
+    /**
+     * Propagate every satellite to dt. The results are written in the order
+     * the satellites were given, each buffer must hold Size() values.
+     * @param[in] dt the time to propagate to
+     * @param[out] x position x in km
+     * @param[out] y position y in km
+     * @param[out] z position z in km
+     * @param[out] vx velocity x in km/s
+     * @param[out] vy velocity y in km/s
+     * @param[out] vz velocity z in km/s
+     * @param[out] status if not NULL the result for each satellite is
+     * written here instead of throwing an exception on error
+     *
+     * If vx, vy and vz are NULL only the positions are calculated.
+     * @exception SatelliteException
+     * @exception DecayedException
+     */
+    void FindPositions(
+            const DateTime& dt,
+            double* x,
+            double* y,
+            double* z,
+            double* vx,
+            double* vy,
+            double* vz,
+            SGP4::Status* status = NULL) const;
+
+    /**
+     * Single precision version of FindPositions(). The secular terms are
+     * still evaluated in double precision, the rest of the near earth
+     * model in single precision. Deep space satellites are propagated in
+     * double precision and rounded.
+     */
+    void FindPositions(
+            const DateTime& dt,
+            float* x,
+            float* y,
+            float* z,
+            float* vx,
+            float* vy,
+            float* vz,
+            SGP4::Status* status = NULL) const;
+
+private:
+#if defined(__AVX512F__)
+    static const size_t kVectorBytes = 64;
+#else
+    static const size_t kVectorBytes = 32;
+#endif
+    static const size_t kLanes = kVectorBytes / sizeof(double);
+
+    template <typename T>
+    struct LaneTraits;
+
+    void Add(const SGP4& model);
+    template <typename T>
+    void FindPositionsAll(
+            const DateTime& dt,
+            T* x,
+            T* y,
+            T* z,
+            T* vx,
+            T* vy,
+            T* vz,
+            SGP4::Status* status) const;
+    template <typename T, bool VELOCITY>
+    void FindPositionsGroup(
+            const size_t group,
+            const long long ticks,
+            T* x,
+            T* y,
+            T* z,
+            T* vx,
+            T* vy,
+            T* vz,
+            SGP4::Status* status) const;
+
+    /*
+     * near earth constants, one column per value with one row per
+     * satellite, padded to a whole number of lane groups
+     */
+    std::vector<long long> epoch_;
+    std::vector<double> xmo_;
+    std::vector<double> omegao_;
+    std::vector<double> xnodeo_;
+    std::vector<double> eo_;
+    std::vector<double> xincl_;
+    std::vector<double> bstar_;
+    std::vector<double> aodp_;
+    std::vector<double> xnodp_;
+    std::vector<double> cosio_;
+    std::vector<double> sinio_;
+    std::vector<double> eta_;
+    std::vector<double> t2cof_;
+    std::vector<double> x1mth2_;
+    std::vector<double> x3thm1_;
+    std::vector<double> x7thm1_;
+    std::vector<double> aycof_;
+    std::vector<double> xlcof_;
+    std::vector<double> xnodcf_;
+    std::vector<double> c1_;
+    std::vector<double> c4_;
+    std::vector<double> omgdot_;
+    std::vector<double> xnodot_;
+    std::vector<double> xmdot_;
+    std::vector<double> c5_;
+    std::vector<double> omgcof_;
+    std::vector<double> xmcof_;
+    std::vector<double> delmo_;
+    std::vector<double> sinmo_;
+    std::vector<double> d2_;
+    std::vector<double> d3_;
+    std::vector<double> d4_;
+    std::vector<double> t3cof_;
+    std::vector<double> t4cof_;
+    std::vector<double> t5cof_;
+
+    /*
+     * original index of each packed near earth satellite
+     */
+    std::vector<size_t> near_index_;
+
+    /*
+     * deep space satellites and their original index
+     */
+    std::vector<SGP4> deep_;
+    std::vector<size_t> deep_index_;
+
+    size_t size_;
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SatelliteCatalog.h"
+
+#include "Threads.h"
+
+#include <exception>
+
+namespace
+{
+    unsigned int NoradNumber(const Tle& tle)
+    {
+        return tle.NoradNumber();
+    }
+
+    unsigned int NoradNumber(const TleRecord& record)
+    {
+        return record.norad_number;
+    }
+
+    unsigned int NoradNumber(const OrbitalElements& elements)
+    {
+        return elements.NoradNumber();
+    }
+}
+
+SatelliteCatalog::SatelliteCatalog(
+        const std::vector<Tle>& tles,
+        const unsigned int threads)
+{
+    Build(tles, threads);
+}
+
+SatelliteCatalog::SatelliteCatalog(
+        const std::vector<TleRecord>& records,
+        const unsigned int threads)
+{
+    Build(records, threads);
+}
+
+SatelliteCatalog::SatelliteCatalog(
+        const std::vector<OrbitalElements>& elements,
+        const unsigned int threads)
+{
+    Build(elements, threads);
+}
+
+template <typename T>
+void SatelliteCatalog::Build(
+        const std::vector<T>& tles,
+        const unsigned int threads)
+{
+    const size_t count = threads > 1 ? threads : 1;
+    std::vector<Share<T> > shares(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        shares[i].tles = &tles;
+        shares[i].first = i;
+        shares[i].stride = count;
+    }
+
+    Threads::RunShares(InitialiseThread<T>, shares);
+
+    /*
+     * satellite i was given to share i % count, as the j'th of that share,
+     * so merge the shares back into the order given
+     */
+    std::vector<size_t> next_model(count, 0);
+    std::vector<size_t> next_error(count, 0);
+
+    models_.reserve(tles.size());
+    index_.reserve(tles.size());
+
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        const size_t s = i % count;
+        Share<T>& share = shares[s];
+
+        if (next_model[s] < share.index.size()
+                && share.index[next_model[s]] == i)
+        {
+            models_.push_back(share.models[next_model[s]]);
+            index_.push_back(i);
+            next_model[s]++;
+        }
+        else
+        {
+            errors_.push_back(share.errors[next_error[s]]);
+            next_error[s]++;
+        }
+    }
+}
+
+template <typename T>
+void* SatelliteCatalog::InitialiseThread(void* arg)
+{
+    Share<T>& share = *static_cast<Share<T>*>(arg);
+    const std::vector<T>& tles = *share.tles;
+
+    share.models.reserve(tles.size() / share.stride + 1);
+    share.index.reserve(tles.size() / share.stride + 1);
+
+    for (size_t i = share.first; i < tles.size(); i += share.stride)
+    {
+        /*
+         * nothing may be thrown out of the thread, so every error is kept
+         * for the caller
+         */
+        try
+        {
+            share.models.push_back(SGP4(tles[i]));
+            share.index.push_back(i);
+        }
+        catch (std::exception& e)
+        {
+            Error error;
+            error.index = i;
+            error.norad_number = NoradNumber(tles[i]);
+            error.message = e.what();
+            share.errors.push_back(error);
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SATELLITECATALOG_H_
+#define SATELLITECATALOG_H_
+
+#include "Tle.h"
+#include "TleRecord.h"
+#include "OrbitalElements.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Initialises a model for every satellite of a catalog in parallel.
+ *
+ * The satellites are shared between threads, each of which initialises its
+ * share of the models, and the models are then gathered into one
+ * contiguous vector in the order the satellites were given. Satellites
+ * which fail to initialise are left out and reported with their error,
+ * rather than stopping the rest of the catalog.
+ *
+ * Initialising deep space satellites costs far more than near earth ones,
+ * so the satellites are dealt out to the threads in turn rather than in
+ * blocks, which keeps the shares even for catalogs sorted by orbit.
+ */
+class SatelliteCatalog
+{
+public:
+    /**
+     * @brief A satellite which failed to initialise.
+     */
+    struct Error
+    {
+        /** the position of the satellite in the list given */
+        size_t index;
+        /** the norad number of the satellite */
+        unsigned int norad_number;
+        /** the message of the exception thrown */
+        std::string message;
+    };
+
+    /**
+     * @param[in] tles the satellites
+     * @param[in] threads the number of threads to initialise with
+     */
+    SatelliteCatalog(
+            const std::vector<Tle>& tles,
+            const unsigned int threads = 1);
+
+    /**
+     * @param[in] records the satellites, such as TleCatalog::Records()
+     * @param[in] threads the number of threads to initialise with
+     */
+    SatelliteCatalog(
+            const std::vector<TleRecord>& records,
+            const unsigned int threads = 1);
+
+    /**
+     * @param[in] elements the satellites, such as OmmCatalog::Elements()
+     * @param[in] threads the number of threads to initialise with
+     */
+    SatelliteCatalog(
+            const std::vector<OrbitalElements>& elements,
+            const unsigned int threads = 1);
+
+    virtual ~SatelliteCatalog()
+    {
+    }
+
+    /**
+     * @returns the number of satellites initialised
+     */
+    size_t Size() const
+    {
+        return models_.size();
+    }
+
+    /**
+     * @param[in] i the model, below Size()
+     * @returns the model
+     */
+    const SGP4& operator[](const size_t i) const
+    {
+        return models_[i];
+    }
+
+    /**
+     * @returns every model, in the order the satellites were given
+     */
+    const std::vector<SGP4>& Models() const
+    {
+        return models_;
+    }
+
+    /**
+     * @param[in] i the model, below Size()
+     * @returns the position in the list given of the satellite of model i
+     */
+    size_t Index(const size_t i) const
+    {
+        return index_[i];
+    }
+
+    /**
+     * @returns the satellites which failed to initialise, in the order they
+     * were given
+     */
+    const std::vector<Error>& Errors() const
+    {
+        return errors_;
+    }
+
+private:
+    /*
+     * the share of the satellites for one thread, and its results
+     */
+    template <typename T>
+    struct Share
+    {
+        const std::vector<T>* tles;
+        size_t first;
+        size_t stride;
+        std::vector<SGP4> models;
+        std::vector<size_t> index;
+        std::vector<Error> errors;
+    };
+
+    template <typename T>
+    void Build(const std::vector<T>& tles, const unsigned int threads);
+    template <typename T>
+    static void* InitialiseThread(void* arg);
+
+    std::vector<SGP4> models_;
+    std::vector<size_t> index_;
+    std::vector<Error> errors_;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef THREADS_H_
+#define THREADS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <pthread.h>
+
+/*
+ * threading helpers shared by the library sources, not installed
+ */
+namespace Threads
+{
+    /*
+     * holds a mutex for the life of the object
+     */
+    class ScopedLock
+    {
+    public:
+        ScopedLock(pthread_mutex_t& mutex)
+            : mutex_(mutex)
+        {
+            pthread_mutex_lock(&mutex_);
+        }
+
+        ~ScopedLock()
+        {
+            pthread_mutex_unlock(&mutex_);
+        }
+
+    private:
+        ScopedLock(const ScopedLock&);
+        ScopedLock& operator=(const ScopedLock&);
+
+        pthread_mutex_t& mutex_;
+    };
+
+    /*
+     * call run once for each share, on a thread of its own for all but the
+     * first. this thread takes the first share, and the share of any thread
+     * which could not be started, so every share is run whatever the
+     * system allows. returns when all of them have finished
+     */
+    template <typename T>
+    void RunShares(void* (*run)(void*), std::vector<T>& shares)
+    {
+        const size_t count = shares.size();
+        std::vector<pthread_t> ids(count);
+        std::vector<bool> started(count, false);
+
+        for (size_t i = 1; i < count; i++)
+        {
+            started[i] = pthread_create(&ids[i], NULL, run, &shares[i]) == 0;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!started[i])
+            {
+                run(&shares[i]);
+            }
+        }
+
+        for (size_t i = 1; i < count; i++)
+        {
+            if (started[i])
+            {
+                pthread_join(ids[i], NULL);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TIMECONTEXT_H_
+#define TIMECONTEXT_H_
+
+#include "DateTime.h"
+#include "Util.h"
+
+/**
+ * @brief The values derived from one instant which every position at that
+ * instant needs.
+ *
+ * The julian date and greenwich sidereal time are found once when the
+ * context is made, so that converting many positions at the same time
+ * does not evaluate the sidereal time polynomial for each one. The values
+ * are calculated exactly as DateTime calculates them, so results through a
+ * context are identical to results through the date.
+ */
+class TimeContext
+{
+public:
+    /**
+     * @param[in] dt the instant
+     */
+    explicit TimeContext(const DateTime& dt)
+        : m_dt(dt),
+        m_julian(dt.ToJulian()),
+        m_gmst(DateTime::GreenwichSiderealTime(m_julian))
+    {
+    }
+
+    /**
+     * @returns the date
+     */
+    DateTime GetDateTime() const
+    {
+        return m_dt;
+    }
+
+    /**
+     * @returns the number of ticks
+     */
+    long long Ticks() const
+    {
+        return m_dt.Ticks();
+    }
+
+    /**
+     * @returns the julian date
+     */
+    double Julian() const
+    {
+        return m_julian;
+    }
+
+    /**
+     * @returns the greenwich sidereal time
+     */
+    double Gmst() const
+    {
+        return m_gmst;
+    }
+
+    /**
+     * @param[in] lon observers longitude
+     * @returns the local mean sidereal time
+     */
+    double LocalMeanSiderealTime(const double lon) const
+    {
+        return Util::WrapTwoPI(m_gmst + lon);
+    }
+
+private:
+    DateTime m_dt;
+    double m_julian;
+    double m_gmst;
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TimeGrid.h"
+
+void TimeGrid::MinutesSince(const DateTime& epoch, double* tsince) const
+{
+    /*
+     * work in ticks relative to epoch, as SGP4::FindPositions() does
+     */
+    const long long offset = start_ - epoch.Ticks();
+
+    for (size_t i = 0; i < count_; i++)
+    {
+        const long long ticks = offset + static_cast<long long>(i) * step_;
+        tsince[i] = static_cast<double>(ticks) / TicksPerMinute;
+    }
+}
+
+void TimeGrid::SiderealTimes(double* gmst) const
+{
+    /*
+     * the julian dates first, as the conversion from ticks has no vector
+     * instruction before AVX-512, so it is kept out of the loop over the
+     * polynomial
+     */
+    for (size_t i = 0; i < count_; i++)
+    {
+        gmst[i] = DateTime::Julian(Ticks(i));
+    }
+
+    /*
+     * the polynomial in blocks of a fixed size, which -O2 vectorises as it
+     * needs no scalar remainder, then whatever is left over
+     */
+    static const size_t kBlock = 16;
+    size_t i = 0;
+
+    for (; i + kBlock <= count_; i += kBlock)
+    {
+        double* block = gmst + i;
+
+        for (size_t j = 0; j < kBlock; j++)
+        {
+            block[j] = DateTime::GreenwichSiderealTime(block[j]);
+        }
+    }
+
+    for (; i < count_; i++)
+    {
+        gmst[i] = DateTime::GreenwichSiderealTime(gmst[i]);
+    }
+}
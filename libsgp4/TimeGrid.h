@@ -0,0 +1,122 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TIMEGRID_H_
+#define TIMEGRID_H_
+
+#include "DateTime.h"
+#include "TimeSpan.h"
+
+#include <cstddef>
+
+/**
+ * @brief Evenly spaced times, held as a start, a step and a count of ticks.
+ *
+ * Times on the grid are found from whole ticks rather than by adding the
+ * step repeatedly, so they do not accumulate rounding errors. The times
+ * since an epoch and the sidereal times of the whole grid are written into
+ * arrays in one pass each. The values are identical to those found from
+ * each DateTime on the grid.
+ *
+ * The sidereal time polynomial is evaluated in blocks of a fixed size,
+ * which GCC vectorises at -O2 when built with --enable-fast-math and
+ * --enable-avx2, as the floor in Util::WrapTwoPI() needs SSE4.1. The
+ * benchmark program compares it with DateTime::ToGreenwichSiderealTime().
+ */
+class TimeGrid
+{
+public:
+    /**
+     * @param[in] start the first time
+     * @param[in] step the interval between times
+     * @param[in] count the number of times
+     */
+    TimeGrid(const DateTime& start, const TimeSpan& step, const size_t count)
+        : start_(start.Ticks()),
+        step_(step.Ticks()),
+        count_(count)
+    {
+    }
+
+    virtual ~TimeGrid()
+    {
+    }
+
+    /**
+     * @returns the first time
+     */
+    DateTime Start() const
+    {
+        return DateTime(static_cast<unsigned long long>(start_));
+    }
+
+    /**
+     * @returns the interval between times
+     */
+    TimeSpan Step() const
+    {
+        return TimeSpan(step_);
+    }
+
+    /**
+     * @returns the number of times
+     */
+    size_t Size() const
+    {
+        return count_;
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns the ticks of time i
+     */
+    long long Ticks(const size_t i) const
+    {
+        return start_ + static_cast<long long>(i) * step_;
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns time i
+     */
+    DateTime At(const size_t i) const
+    {
+        return DateTime(static_cast<unsigned long long>(Ticks(i)));
+    }
+
+    /**
+     * Write the time of each point since epoch in minutes, as used by
+     * SGP4::FindPositions(). The buffer must hold Size() values.
+     * @param[in] epoch the epoch of the elements
+     * @param[out] tsince times since epoch in minutes
+     */
+    void MinutesSince(const DateTime& epoch, double* tsince) const;
+
+    /**
+     * Write the greenwich sidereal time of each point. The buffer must hold
+     * Size() values.
+     * @param[out] gmst the greenwich sidereal times
+     */
+    void SiderealTimes(double* gmst) const;
+
+private:
+    long long start_;
+    long long step_;
+    size_t count_;
+};
+
+#endif
@@ -17,7 +17,13 @@
 
 #include "Tle.h"
 
-#include <locale> 
+#include <algorithm>
+#include <cstring>
+
+/*
+ * std::min() takes the name length by reference, so it needs a definition
+ */
+const size_t TleRecord::kNameLength;
 
 namespace
 {
@@ -78,12 +84,69 @@ void Tle::Initialize()
         throw TleException("Invalid length for line two");
     }
 
-    if (line_one_[0] != '1')
+    TleRecord record;
+    Parse(name_.data(), name_.length(),
+            line_one_.data(), line_two_.data(), record);
+
+    norad_number_ = record.norad_number;
+
+    if (name_.empty())
+    {
+        name_ = record.name;
+    }
+
+    int_designator_ = record.int_designator;
+    epoch_ = DateTime(record.epoch);
+    mean_motion_dt2_ = record.mean_motion_dt2;
+    mean_motion_ddt6_ = record.mean_motion_ddt6;
+    bstar_ = record.bstar;
+    inclination_ = record.inclination;
+    right_ascending_node_ = record.right_ascending_node;
+    eccentricity_ = record.eccentricity;
+    argument_perigee_ = record.argument_perigee;
+    mean_anomaly_ = record.mean_anomaly;
+    mean_motion_ = record.mean_motion;
+    orbit_number_ = record.orbit_number;
+}
+
+Tle::Tle(const TleRecord& record)
+    : name_(record.name),
+    line_one_(record.line_one, TLE_LEN_LINE_DATA),
+    line_two_(record.line_two, TLE_LEN_LINE_DATA),
+    norad_number_(record.norad_number),
+    int_designator_(record.int_designator),
+    epoch_(record.epoch),
+    mean_motion_dt2_(record.mean_motion_dt2),
+    mean_motion_ddt6_(record.mean_motion_ddt6),
+    bstar_(record.bstar),
+    inclination_(record.inclination),
+    right_ascending_node_(record.right_ascending_node),
+    eccentricity_(record.eccentricity),
+    argument_perigee_(record.argument_perigee),
+    mean_anomaly_(record.mean_anomaly),
+    mean_motion_(record.mean_motion),
+    orbit_number_(record.orbit_number)
+{
+}
+
+/**
+ * Decode the lines of a tle into a record. The fields are decoded in
+ * place, without copying them out.
+ * @exception TleException
+ */
+void Tle::Parse(
+        const char* name,
+        const size_t name_length,
+        const char* line_one,
+        const char* line_two,
+        TleRecord& record)
+{
+    if (line_one[0] != '1')
     {
         throw TleException("Invalid line beginning for line one");
     }
         
-    if (line_two_[0] != '2')
+    if (line_two[0] != '2')
     {
         throw TleException("Invalid line beginning for line two");
     }
@@ -91,63 +154,110 @@ void Tle::Initialize()
     unsigned int sat_number_1;
     unsigned int sat_number_2;
 
-    ExtractInteger(line_one_.substr(TLE1_COL_NORADNUM,
-                TLE1_LEN_NORADNUM), sat_number_1);
-    ExtractInteger(line_two_.substr(TLE2_COL_NORADNUM,
-                TLE2_LEN_NORADNUM), sat_number_2);
+    ExtractInteger(line_one + TLE1_COL_NORADNUM,
+            TLE1_LEN_NORADNUM, sat_number_1);
+    ExtractInteger(line_two + TLE2_COL_NORADNUM,
+            TLE2_LEN_NORADNUM, sat_number_2);
 
     if (sat_number_1 != sat_number_2)
     {
         throw TleException("Satellite numbers do not match");
     }
 
-    norad_number_ = sat_number_1;
+    record.norad_number = sat_number_1;
 
-    if (name_.empty())
+    if (name_length == 0)
     {
-        name_ = line_one_.substr(TLE1_COL_NORADNUM, TLE1_LEN_NORADNUM);
+        memcpy(record.name, line_one + TLE1_COL_NORADNUM,
+                TLE1_LEN_NORADNUM);
+        record.name[TLE1_LEN_NORADNUM] = '\0';
     }
+    else
+    {
+        const size_t length = std::min(name_length, TleRecord::kNameLength);
+        memcpy(record.name, name, length);
+        record.name[length] = '\0';
+    }
+
+    memcpy(record.line_one, line_one, TLE_LEN_LINE_DATA);
+    record.line_one[TLE_LEN_LINE_DATA] = '\0';
+    memcpy(record.line_two, line_two, TLE_LEN_LINE_DATA);
+    record.line_two[TLE_LEN_LINE_DATA] = '\0';
 
-    int_designator_ = line_one_.substr(TLE1_COL_INTLDESC_A,
-            TLE1_LEN_INTLDESC_A + TLE1_LEN_INTLDESC_B + TLE1_LEN_INTLDESC_C);
+    memcpy(record.int_designator, line_one + TLE1_COL_INTLDESC_A,
+            TleRecord::kIntDesignatorLength);
+    record.int_designator[TleRecord::kIntDesignatorLength] = '\0';
 
     unsigned int year = 0;
     double day = 0.0;
 
-    ExtractInteger(line_one_.substr(TLE1_COL_EPOCH_A,
-                TLE1_LEN_EPOCH_A), year);
-    ExtractDouble(line_one_.substr(TLE1_COL_EPOCH_B,
-                TLE1_LEN_EPOCH_B), 4, day);
-    ExtractDouble(line_one_.substr(TLE1_COL_MEANMOTIONDT2,
-                TLE1_LEN_MEANMOTIONDT2), 2, mean_motion_dt2_);
-    ExtractExponential(line_one_.substr(TLE1_COL_MEANMOTIONDDT6,
-                TLE1_LEN_MEANMOTIONDDT6), mean_motion_ddt6_);
-    ExtractExponential(line_one_.substr(TLE1_COL_BSTAR,
-                TLE1_LEN_BSTAR), bstar_);
+    ExtractInteger(line_one + TLE1_COL_EPOCH_A,
+            TLE1_LEN_EPOCH_A, year);
+    ExtractDouble(line_one + TLE1_COL_EPOCH_B,
+            TLE1_LEN_EPOCH_B, 4, day);
+    ExtractDouble(line_one + TLE1_COL_MEANMOTIONDT2,
+            TLE1_LEN_MEANMOTIONDT2, 2, record.mean_motion_dt2);
+    ExtractExponential(line_one + TLE1_COL_MEANMOTIONDDT6,
+            TLE1_LEN_MEANMOTIONDDT6, record.mean_motion_ddt6);
+    ExtractExponential(line_one + TLE1_COL_BSTAR,
+            TLE1_LEN_BSTAR, record.bstar);
 
     /*
      * line 2
      */
-    ExtractDouble(line_two_.substr(TLE2_COL_INCLINATION,
-                TLE2_LEN_INCLINATION), 4, inclination_);
-    ExtractDouble(line_two_.substr(TLE2_COL_RAASCENDNODE,
-                TLE2_LEN_RAASCENDNODE), 4, right_ascending_node_);
-    ExtractDouble(line_two_.substr(TLE2_COL_ECCENTRICITY,
-                TLE2_LEN_ECCENTRICITY), -1, eccentricity_);
-    ExtractDouble(line_two_.substr(TLE2_COL_ARGPERIGEE,
-                TLE2_LEN_ARGPERIGEE), 4, argument_perigee_);
-    ExtractDouble(line_two_.substr(TLE2_COL_MEANANOMALY,
-                TLE2_LEN_MEANANOMALY), 4, mean_anomaly_);
-    ExtractDouble(line_two_.substr(TLE2_COL_MEANMOTION,
-                TLE2_LEN_MEANMOTION), 3, mean_motion_);
-    ExtractInteger(line_two_.substr(TLE2_COL_REVATEPOCH,
-                TLE2_LEN_REVATEPOCH), orbit_number_);
+    ExtractDouble(line_two + TLE2_COL_INCLINATION,
+            TLE2_LEN_INCLINATION, 4, record.inclination);
+    ExtractDouble(line_two + TLE2_COL_RAASCENDNODE,
+            TLE2_LEN_RAASCENDNODE, 4, record.right_ascending_node);
+    ExtractDouble(line_two + TLE2_COL_ECCENTRICITY,
+            TLE2_LEN_ECCENTRICITY, -1, record.eccentricity);
+    ExtractDouble(line_two + TLE2_COL_ARGPERIGEE,
+            TLE2_LEN_ARGPERIGEE, 4, record.argument_perigee);
+    ExtractDouble(line_two + TLE2_COL_MEANANOMALY,
+            TLE2_LEN_MEANANOMALY, 4, record.mean_anomaly);
+    ExtractDouble(line_two + TLE2_COL_MEANMOTION,
+            TLE2_LEN_MEANMOTION, 3, record.mean_motion);
+    ExtractInteger(line_two + TLE2_COL_REVATEPOCH,
+            TLE2_LEN_REVATEPOCH, record.orbit_number);
     
     if (year < 57)
         year += 2000;
     else
         year += 1900;
-    epoch_ = DateTime(year, day);
+    record.epoch = DateTime(static_cast<int>(year), day).Ticks();
+}
+
+TleRecord Tle::Record() const
+{
+    TleRecord record;
+
+    const size_t length = std::min(name_.length(), TleRecord::kNameLength);
+    memcpy(record.name, name_.data(), length);
+    record.name[length] = '\0';
+
+    memcpy(record.line_one, line_one_.data(), TLE_LEN_LINE_DATA);
+    record.line_one[TLE_LEN_LINE_DATA] = '\0';
+    memcpy(record.line_two, line_two_.data(), TLE_LEN_LINE_DATA);
+    record.line_two[TLE_LEN_LINE_DATA] = '\0';
+
+    memcpy(record.int_designator, int_designator_.data(),
+            TleRecord::kIntDesignatorLength);
+    record.int_designator[TleRecord::kIntDesignatorLength] = '\0';
+
+    record.norad_number = norad_number_;
+    record.orbit_number = orbit_number_;
+    record.epoch = epoch_.Ticks();
+    record.mean_motion_dt2 = mean_motion_dt2_;
+    record.mean_motion_ddt6 = mean_motion_ddt6_;
+    record.bstar = bstar_;
+    record.inclination = inclination_;
+    record.right_ascending_node = right_ascending_node_;
+    record.eccentricity = eccentricity_;
+    record.argument_perigee = argument_perigee_;
+    record.mean_anomaly = mean_anomaly_;
+    record.mean_motion = mean_motion_;
+
+    return record;
 }
 
 /**
@@ -161,22 +271,78 @@ bool Tle::IsValidLineLength(const std::string& str)
 }
 
 /**
- * Convert a string containing an integer
- * @param[in] str The string to convert
+ * Check the modulo 10 checksum in the last column of a line, which counts
+ * each digit as its value and each minus sign as one
+ * @param[in] line the line, of LineLength() characters
+ * @returns whether the checksum matches
+ */
+bool Tle::IsValidChecksum(const char* line)
+{
+    unsigned int sum = 0;
+
+    for (unsigned int i = 0; i < TLE_LEN_LINE_DATA - 1; i++)
+    {
+        if (IsDigit(line[i]))
+        {
+            sum += static_cast<unsigned int>(line[i] - '0');
+        }
+        else if (line[i] == '-')
+        {
+            sum++;
+        }
+    }
+
+    const char check = line[TLE_LEN_LINE_DATA - 1];
+
+    return IsDigit(check)
+        && static_cast<unsigned int>(check - '0') == sum % 10;
+}
+
+/**
+ * Scale an integer by a power of ten. The integer and the power are both
+ * exact, so the one rounding gives the same result as parsing the decimal
+ * string
+ * @param[in] digits the integer, below 2^53
+ * @param[in] exponent the power of ten, from -22 to 22
+ * @returns digits * 10^exponent
+ */
+double Tle::Scale(const unsigned long long digits, const int exponent)
+{
+    static const double kPowers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const double value = static_cast<double>(digits);
+
+    if (exponent < 0)
+    {
+        return value / kPowers[-exponent];
+    }
+    return value * kPowers[exponent];
+}
+
+/**
+ * Convert a field containing an integer
+ * @param[in] str The field to convert
+ * @param[in] length The length of the field
  * @param[out] val The result
  * @exception TleException on conversion error
  */
-void Tle::ExtractInteger(const std::string& str, unsigned int& val)
+void Tle::ExtractInteger(
+        const char* str,
+        const unsigned int length,
+        unsigned int& val)
 {
     bool found_digit = false;
     unsigned int temp = 0;
 
-    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    for (const char* i = str; i != str + length; ++i)
     {
-        if (isdigit(*i))
+        if (IsDigit(*i))
         {
             found_digit = true;
-            temp = (temp * 10) + (*i - '0');
+            temp = (temp * 10) + static_cast<unsigned int>(*i - '0');
         }
         else if (found_digit)
         {
@@ -199,44 +365,52 @@ void Tle::ExtractInteger(const std::string& str, unsigned int& val)
 }
 
 /**
- * Convert a string containing an double
- * @param[in] str The string to convert
+ * Convert a field containing an double
+ * @param[in] str The field to convert
+ * @param[in] length The length of the field
  * @param[in] point_pos The position of the decimal point. (-1 if none)
  * @param[out] val The result
  * @exception TleException on conversion error
  */
-void Tle::ExtractDouble(const std::string& str, int point_pos, double& val)
+void Tle::ExtractDouble(
+        const char* str,
+        const unsigned int length,
+        int point_pos,
+        double& val)
 {
-    std::string temp;
+    bool negative = false;
     bool found_digit = false;
+    unsigned long long digits = 0;
+    int fraction_digits = 0;
 
-    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    for (const char* i = str; i != str + length; ++i)
     {
         /*
          * integer part
          */
-        if (point_pos >= 0 && i < str.begin() + point_pos - 1)
+        if (point_pos >= 0 && i < str + point_pos - 1)
         {
             bool done = false;
 
-            if (i == str.begin())
+            if (i == str)
             {
                 if(*i == '-' || *i == '+')
                 {
                     /*
                      * first character could be signed
                      */
-                    temp += *i;
+                    negative = *i == '-';
                     done = true;
                 }
             }
 
             if (!done)
             {
-                if (isdigit(*i))
+                if (IsDigit(*i))
                 {
                     found_digit = true;
-                    temp += *i;
+                    digits = digits * 10
+                        + static_cast<unsigned long long>(*i - '0');
                 }
                 else if (found_digit)
                 {
@@ -251,24 +425,9 @@ void Tle::ExtractDouble(const std::string& str, int point_pos, double& val)
         /*
          * decimal point
          */
-        else if (point_pos >= 0 && i == str.begin() + point_pos - 1)
+        else if (point_pos >= 0 && i == str + point_pos - 1)
         {
-            if (temp.length() == 0)
-            {
-                /*
-                 * integer part is blank, so add a '0'
-                 */
-                temp += '0';
-            }
-
-            if (*i == '.')
-            {
-                /*
-                 * decimal point found
-                 */
-                temp += *i;
-            }
-            else
+            if (*i != '.')
             {
                 throw TleException("Failed to find decimal point");
             }
@@ -278,21 +437,14 @@ void Tle::ExtractDouble(const std::string& str, int point_pos, double& val)
          */
         else
         {
-            if (i == str.begin() && point_pos == -1)
-            {
-                /*
-                 * no decimal point expected, add 0. beginning
-                 */
-                temp += '0';
-                temp += '.';
-            }
-            
             /*
              * should be a digit
              */
-            if (isdigit(*i))
+            if (IsDigit(*i))
             {
-                temp += *i;
+                digits = digits * 10
+                    + static_cast<unsigned long long>(*i - '0');
+                fraction_digits++;
             }
             else
             {
@@ -301,46 +453,49 @@ void Tle::ExtractDouble(const std::string& str, int point_pos, double& val)
         }
     }
 
-    if (!Util::FromString<double>(temp, val))
+    val = Scale(digits, -fraction_digits);
+    if (negative)
     {
-        throw TleException("Failed to convert value to double");
+        val = -val;
     }
 }
 
 /**
- * Convert a string containing an exponential
- * @param[in] str The string to convert
+ * Convert a field containing an exponential
+ * @param[in] str The field to convert
+ * @param[in] length The length of the field
  * @param[out] val The result
  * @exception TleException on conversion error
  */
-void Tle::ExtractExponential(const std::string& str, double& val)
+void Tle::ExtractExponential(
+        const char* str,
+        const unsigned int length,
+        double& val)
 {
-    std::string temp;
+    bool negative = false;
+    unsigned long long digits = 0;
+    int mantissa_digits = 0;
+    int exponent = 0;
+    bool negative_exponent = false;
 
-    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    for (const char* i = str; i != str + length; ++i)
     {
-        if (i == str.begin())
+        if (i == str)
         {
             if (*i == '-' || *i == '+' || *i == ' ')
             {
-                if (*i == '-')
-                {
-                    temp += *i;
-                }
-                temp += '0';
-                temp += '.';
+                negative = *i == '-';
             }
             else
             {
                 throw TleException("Invalid sign");
             }
         }
-        else if (i == str.begin() + str.length() - 2)
+        else if (i == str + length - 2)
         {
             if (*i == '-' || *i == '+')
             {
-                temp += 'e';
-                temp += *i;
+                negative_exponent = *i == '-';
             }
             else
             {
@@ -349,9 +504,18 @@ void Tle::ExtractExponential(const std::string& str, double& val)
         }
         else
         {
-            if (isdigit(*i))
+            if (IsDigit(*i))
             {
-                temp += *i;
+                if (i < str + length - 2)
+                {
+                    digits = digits * 10
+                        + static_cast<unsigned long long>(*i - '0');
+                    mantissa_digits++;
+                }
+                else
+                {
+                    exponent = *i - '0';
+                }
             }
             else
             {
@@ -360,8 +524,13 @@ void Tle::ExtractExponential(const std::string& str, double& val)
         }
     }
 
-    if (!Util::FromString<double>(temp, val))
+    /*
+     * the mantissa has an implied leading decimal point
+     */
+    val = Scale(digits, (negative_exponent ? -exponent : exponent)
+            - mantissa_digits);
+    if (negative)
     {
-        throw TleException("Failed to convert value to double");
+        val = -val;
     }
 }
@@ -21,6 +21,9 @@
 #include "Util.h"
 #include "DateTime.h"
 #include "TleException.h"
+#include "TleRecord.h"
+
+#include <cstddef>
 
 /**
  * @brief Processes a two-line element set used to convey OrbitalElements.
@@ -60,30 +63,30 @@ public:
     }
 
     /**
-     * Copy constructor
-     * @param[in] tle Tle object to copy from
+     * @details Initialise from text held elsewhere, such as a mapped file,
+     * without building intermediate strings
+     * @param[in] name Satellite name
+     * @param[in] name_length Length of the satellite name
+     * @param[in] line_one Tle line one, of LineLength() characters
+     * @param[in] line_two Tle line two, of LineLength() characters
      */
-    Tle(const Tle& tle)
+    Tle(const char* name,
+            const size_t name_length,
+            const char* line_one,
+            const char* line_two)
+        : name_(name, name_length),
+        line_one_(line_one, TLE_LEN_LINE_DATA),
+        line_two_(line_two, TLE_LEN_LINE_DATA)
     {
-        name_ = tle.name_;
-        line_one_ = tle.line_one_;
-        line_two_ = tle.line_two_;
-
-        norad_number_ = tle.norad_number_;
-        int_designator_ = tle.int_designator_;
-        epoch_ = tle.epoch_;
-        mean_motion_dt2_ = tle.mean_motion_dt2_;
-        mean_motion_ddt6_ = tle.mean_motion_ddt6_;
-        bstar_ = tle.bstar_;
-        inclination_ = tle.inclination_;
-        right_ascending_node_ = tle.right_ascending_node_;
-        eccentricity_ = tle.eccentricity_;
-        argument_perigee_ = tle.argument_perigee_;
-        mean_anomaly_ = tle.mean_anomaly_;
-        mean_motion_ = tle.mean_motion_;
-        orbit_number_ = tle.orbit_number_;
+        Initialize();
     }
 
+    /**
+     * @details Initialise from a record, without decoding the lines again
+     * @param[in] record the record
+     */
+    Tle(const TleRecord& record);
+
     /**
      * Destructor
      */
@@ -275,6 +278,35 @@ public:
     {
         return TLE_LEN_LINE_DATA;
     }
+
+    /**
+     * Decode an element set into a record, without allocating any memory
+     * @param[in] name Satellite name
+     * @param[in] name_length Length of the satellite name
+     * @param[in] line_one Tle line one, of LineLength() characters
+     * @param[in] line_two Tle line two, of LineLength() characters
+     * @param[out] record the decoded element set
+     * @exception TleException
+     */
+    static void Parse(
+            const char* name,
+            const size_t name_length,
+            const char* line_one,
+            const char* line_two,
+            TleRecord& record);
+
+    /**
+     * @returns this element set as a record, with the name cut short to
+     * TleRecord::kNameLength characters
+     */
+    TleRecord Record() const;
+
+    /**
+     * Check the checksum in the last column of a line
+     * @param[in] line the line, of LineLength() characters
+     * @returns whether the checksum matches
+     */
+    static bool IsValidChecksum(const char* line);
     
     /**
      * Dump this object to a string
@@ -313,9 +345,24 @@ public:
 private:
     void Initialize();
     static bool IsValidLineLength(const std::string& str);
-    void ExtractInteger(const std::string& str, unsigned int& val);
-    void ExtractDouble(const std::string& str, int point_pos, double& val);
-    void ExtractExponential(const std::string& str, double& val);
+    static bool IsDigit(const char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+    static double Scale(const unsigned long long digits, const int exponent);
+    static void ExtractInteger(
+            const char* str,
+            const unsigned int length,
+            unsigned int& val);
+    static void ExtractDouble(
+            const char* str,
+            const unsigned int length,
+            int point_pos,
+            double& val);
+    static void ExtractExponential(
+            const char* str,
+            const unsigned int length,
+            double& val);
 
 private:
     std::string name_;
@@ -0,0 +1,668 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TleArchive.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * the number of element sets read from a spilled chunk at once
+     */
+    const size_t kRunBlock = 256;
+
+    /*
+     * the most spilled chunks open at once, well inside the usual limit of
+     * 1024 file descriptors
+     */
+    const size_t kFanIn = 64;
+
+    bool RecordLess(const TleRecord& a, const TleRecord& b)
+    {
+        return a.norad_number < b.norad_number
+            || (a.norad_number == b.norad_number && a.epoch < b.epoch);
+    }
+
+    bool RecordEqual(const TleRecord& a, const TleRecord& b)
+    {
+        return a.norad_number == b.norad_number && a.epoch == b.epoch;
+    }
+
+    void Check(const std::ios& file, const char* message)
+    {
+        if (!file.good())
+        {
+            throw TleException(message);
+        }
+    }
+
+    /*
+     * a sorted chunk of element sets, either held in memory or spilled to
+     * a file and read back a block at a time
+     */
+    class Run
+    {
+    public:
+        Run(std::vector<TleRecord>& records)
+            : position_(0)
+        {
+            records_.swap(records);
+        }
+
+        Run(const std::string& filename)
+            : file_(filename.c_str(), std::ios::in | std::ios::binary),
+            position_(0)
+        {
+            Check(file_, "Error opening archive chunk");
+            Fill();
+        }
+
+        bool Empty() const
+        {
+            return position_ == records_.size();
+        }
+
+        const TleRecord& Current() const
+        {
+            return records_[position_];
+        }
+
+        void Next()
+        {
+            if (++position_ == records_.size() && file_.is_open())
+            {
+                Fill();
+            }
+        }
+
+    private:
+        Run(const Run&);
+        Run& operator=(const Run&);
+
+        void Fill()
+        {
+            records_.resize(kRunBlock);
+            file_.read(reinterpret_cast<char*>(&records_[0]),
+                    static_cast<std::streamsize>(
+                        kRunBlock * sizeof(TleRecord)));
+
+            const size_t bytes = static_cast<size_t>(file_.gcount());
+            if (file_.bad() || bytes % sizeof(TleRecord) != 0)
+            {
+                throw TleException("Error reading archive chunk");
+            }
+
+            records_.resize(bytes / sizeof(TleRecord));
+            position_ = 0;
+
+            if (records_.empty())
+            {
+                file_.close();
+            }
+        }
+
+        std::ifstream file_;
+        std::vector<TleRecord> records_;
+        size_t position_;
+    };
+
+    /*
+     * orders runs by their current element set, then by the order they
+     * were read, for a heap with the least at the top
+     */
+    class RunGreater
+    {
+    public:
+        RunGreater(const std::vector<Run*>& runs)
+            : runs_(&runs)
+        {
+        }
+
+        bool operator()(const size_t a, const size_t b) const
+        {
+            const TleRecord& ra = (*runs_)[a]->Current();
+            const TleRecord& rb = (*runs_)[b]->Current();
+
+            return RecordLess(rb, ra) || (RecordEqual(ra, rb) && a > b);
+        }
+
+    private:
+        const std::vector<Run*>* runs_;
+    };
+
+    /*
+     * the runs and temporary files of a build, which are deleted and
+     * removed however the build ends
+     */
+    class BuildFiles
+    {
+    public:
+        BuildFiles()
+        {
+        }
+
+        ~BuildFiles()
+        {
+            for (size_t i = 0; i < runs.size(); i++)
+            {
+                delete runs[i];
+            }
+            for (size_t i = 0; i < temporary.size(); i++)
+            {
+                std::remove(temporary[i].c_str());
+            }
+        }
+
+        std::vector<Run*> runs;
+        std::vector<std::string> temporary;
+
+    private:
+        BuildFiles(const BuildFiles&);
+        BuildFiles& operator=(const BuildFiles&);
+    };
+
+    /*
+     * merges runs in order, giving the first of the element sets read for
+     * each satellite and epoch
+     */
+    class Merge
+    {
+    public:
+        Merge(const std::vector<Run*>& runs)
+            : runs_(runs),
+            heap_(RunGreater(runs)),
+            given_(false),
+            last_(TleRecord())
+        {
+            for (size_t i = 0; i < runs_.size(); i++)
+            {
+                if (!runs_[i]->Empty())
+                {
+                    heap_.push(i);
+                }
+            }
+        }
+
+        /*
+         * returns false once every run is empty
+         */
+        bool Next(TleRecord& record)
+        {
+            while (!heap_.empty())
+            {
+                const size_t top = heap_.top();
+                heap_.pop();
+                Run& run = *runs_[top];
+                const TleRecord current = run.Current();
+
+                run.Next();
+                if (!run.Empty())
+                {
+                    heap_.push(top);
+                }
+
+                if (!given_ || !RecordEqual(current, last_))
+                {
+                    given_ = true;
+                    last_ = current;
+                    record = current;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        Merge(const Merge&);
+        Merge& operator=(const Merge&);
+
+        const std::vector<Run*>& runs_;
+        std::priority_queue<size_t, std::vector<size_t>, RunGreater> heap_;
+        bool given_;
+        TleRecord last_;
+    };
+
+    /*
+     * merge spilled chunks into one new chunk
+     */
+    void MergeChunks(
+            const std::vector<std::string>& chunks,
+            const std::string& filename)
+    {
+        BuildFiles files;
+
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            files.runs.push_back(new Run(chunks[i]));
+        }
+
+        std::ofstream out(filename.c_str(),
+                std::ios::out | std::ios::binary | std::ios::trunc);
+        Merge merge(files.runs);
+        TleRecord record;
+
+        while (merge.Next(record))
+        {
+            out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+
+        out.close();
+        Check(out, "Error writing archive chunk");
+    }
+
+    /*
+     * sort a chunk, keeping the first of the element sets read for each
+     * satellite and epoch
+     */
+    void SortChunk(std::vector<TleRecord>& chunk)
+    {
+        std::stable_sort(chunk.begin(), chunk.end(), RecordLess);
+        chunk.erase(std::unique(chunk.begin(), chunk.end(), RecordEqual),
+                chunk.end());
+    }
+}
+
+TleArchive::TleArchive(const std::string& filename)
+    : map_(MAP_FAILED),
+    size_(0),
+    header_(NULL),
+    records_(NULL),
+    epochs_(NULL),
+    index_(NULL)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw TleException("Error opening archive");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw TleException("Error reading archive size");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ < sizeof(TleArchiveFile::Header))
+    {
+        close(fd);
+        throw TleException("Archive is too short");
+    }
+
+    map_ = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map_ == MAP_FAILED)
+    {
+        throw TleException("Error mapping archive");
+    }
+
+    const char* base = static_cast<const char*>(map_);
+    header_ = reinterpret_cast<const TleArchiveFile::Header*>(base);
+
+    const uint64_t records = header_->records;
+    const char* error = NULL;
+    if (memcmp(header_->magic, TleArchiveFile::kMagic,
+                sizeof(header_->magic)) != 0)
+    {
+        error = "Not an archive";
+    }
+    else if (header_->version != TleArchiveFile::kVersion)
+    {
+        error = "Unsupported archive version";
+    }
+    else if (header_->record_size != sizeof(TleRecord)
+            || header_->records_offset % sizeof(uint64_t) != 0
+            || header_->epochs_offset % sizeof(uint64_t) != 0
+            || header_->index_offset % sizeof(uint64_t) != 0)
+    {
+        error = "Invalid archive header";
+    }
+    else if (header_->records_offset > size_
+            || records > (size_ - header_->records_offset)
+                / sizeof(TleRecord)
+            || header_->epochs_offset > size_
+            || records > (size_ - header_->epochs_offset)
+                / sizeof(uint64_t)
+            || header_->index_offset > size_
+            || header_->satellites > (size_ - header_->index_offset)
+                / sizeof(TleArchiveFile::Index))
+    {
+        error = "Archive is truncated";
+    }
+    else
+    {
+        records_ = reinterpret_cast<const TleRecord*>(
+                base + header_->records_offset);
+        epochs_ = reinterpret_cast<const uint64_t*>(
+                base + header_->epochs_offset);
+        index_ = reinterpret_cast<const TleArchiveFile::Index*>(
+                base + header_->index_offset);
+
+        for (uint64_t i = 0; i < header_->satellites && error == NULL; i++)
+        {
+            if (index_[i].count == 0
+                    || index_[i].first > records
+                    || index_[i].count > records - index_[i].first)
+            {
+                error = "Archive index is invalid";
+            }
+            else if (i > 0
+                    && index_[i].norad_number <= index_[i - 1].norad_number)
+            {
+                error = "Archive index is not sorted";
+            }
+        }
+    }
+
+    if (error != NULL)
+    {
+        munmap(map_, size_);
+        throw TleException(error);
+    }
+}
+
+TleArchive::~TleArchive()
+{
+    munmap(map_, size_);
+}
+
+size_t TleArchive::Build(
+        TleStream& input,
+        const std::string& filename,
+        const size_t chunk)
+{
+    const size_t chunk_size = chunk > 1 ? chunk : 1;
+    BuildFiles files;
+    std::vector<std::string> chunks;
+    std::vector<TleRecord> records;
+    records.reserve(chunk_size);
+
+    /*
+     * sort the input a chunk at a time, spilling every full chunk to a file
+     */
+    TleRecord record;
+    while (input.Next(record))
+    {
+        records.push_back(record);
+
+        if (records.size() == chunk_size)
+        {
+            SortChunk(records);
+
+            std::ostringstream name;
+            name << filename << ".run" << files.temporary.size();
+            files.temporary.push_back(name.str());
+            chunks.push_back(name.str());
+
+            std::ofstream run(name.str().c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+            run.write(reinterpret_cast<const char*>(&records[0]),
+                    static_cast<std::streamsize>(
+                        records.size() * sizeof(TleRecord)));
+            run.close();
+            Check(run, "Error writing archive chunk");
+
+            records.clear();
+        }
+    }
+
+    /*
+     * merge consecutive groups of chunks into longer ones until few enough
+     * are left to open at once. groups keep the order the chunks were read
+     * in, so the first of any repeated element sets is still the one kept
+     */
+    while (chunks.size() > kFanIn)
+    {
+        std::vector<std::string> merged;
+
+        for (size_t begin = 0; begin < chunks.size(); begin += kFanIn)
+        {
+            const size_t end = std::min(begin + kFanIn, chunks.size());
+            const std::vector<std::string> group(
+                    chunks.begin() + static_cast<long>(begin),
+                    chunks.begin() + static_cast<long>(end));
+
+            if (group.size() == 1)
+            {
+                merged.push_back(group[0]);
+                continue;
+            }
+
+            std::ostringstream name;
+            name << filename << ".run" << files.temporary.size();
+            files.temporary.push_back(name.str());
+            merged.push_back(name.str());
+
+            MergeChunks(group, name.str());
+
+            for (size_t i = 0; i < group.size(); i++)
+            {
+                std::remove(group[i].c_str());
+            }
+        }
+
+        chunks.swap(merged);
+    }
+
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        files.runs.push_back(new Run(chunks[i]));
+    }
+
+    /*
+     * the last chunk is merged from memory
+     */
+    SortChunk(records);
+    files.runs.push_back(new Run(records));
+
+    const std::string epochs_name = filename + ".epochs";
+    files.temporary.push_back(epochs_name);
+
+    std::ofstream file(filename.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+    std::ofstream epochs(epochs_name.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+    Check(file, "Error creating archive");
+    Check(epochs, "Error creating archive");
+
+    /*
+     * reserve space for the header, which is written last
+     */
+    TleArchiveFile::Header header = TleArchiveFile::Header();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    /*
+     * merge the runs, dropping element sets for a satellite and epoch
+     * already written
+     */
+    Merge merge(files.runs);
+    std::vector<TleArchiveFile::Index> index;
+    uint64_t count = 0;
+    TleRecord current;
+
+    while (merge.Next(current))
+    {
+        if (count == 0 || current.norad_number != index.back().norad_number)
+        {
+            TleArchiveFile::Index entry = TleArchiveFile::Index();
+            entry.norad_number = current.norad_number;
+            entry.first = count;
+            index.push_back(entry);
+        }
+
+        const uint64_t epoch = current.epoch;
+        file.write(reinterpret_cast<const char*>(&current), sizeof(current));
+        epochs.write(reinterpret_cast<const char*>(&epoch), sizeof(epoch));
+        index.back().count++;
+        count++;
+    }
+
+    epochs.close();
+    Check(file, "Error writing archive");
+    Check(epochs, "Error writing archive");
+
+    /*
+     * append the epochs and the index
+     */
+    std::ifstream copy(epochs_name.c_str(), std::ios::in | std::ios::binary);
+    std::vector<char> buffer(1 << 16);
+    Check(copy, "Error reading archive epochs");
+
+    while (copy)
+    {
+        copy.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+        file.write(&buffer[0], copy.gcount());
+    }
+    if (copy.bad())
+    {
+        throw TleException("Error reading archive epochs");
+    }
+
+    if (!index.empty())
+    {
+        file.write(reinterpret_cast<const char*>(&index[0]),
+                static_cast<std::streamsize>(
+                    index.size() * sizeof(TleArchiveFile::Index)));
+    }
+
+    memcpy(header.magic, TleArchiveFile::kMagic, sizeof(header.magic));
+    header.version = TleArchiveFile::kVersion;
+    header.record_size = static_cast<uint32_t>(sizeof(TleRecord));
+    header.records = count;
+    header.satellites = index.size();
+    header.records_offset = sizeof(header);
+    header.epochs_offset = header.records_offset + count * sizeof(TleRecord);
+    header.index_offset = header.epochs_offset + count * sizeof(uint64_t);
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    Check(file, "Error writing archive");
+
+    return static_cast<size_t>(count);
+}
+
+const TleArchiveFile::Index* TleArchive::Satellite(
+        const unsigned int norad_number) const
+{
+    size_t low = 0;
+    size_t high = Satellites();
+
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+
+        if (index_[middle].norad_number < norad_number)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == Satellites() || index_[low].norad_number != norad_number)
+    {
+        return NULL;
+    }
+
+    return &index_[low];
+}
+
+const TleRecord* TleArchive::History(
+        const unsigned int norad_number,
+        size_t& count) const
+{
+    const TleArchiveFile::Index* satellite = Satellite(norad_number);
+
+    if (satellite == NULL)
+    {
+        count = 0;
+        return NULL;
+    }
+
+    count = static_cast<size_t>(satellite->count);
+    return records_ + satellite->first;
+}
+
+const TleRecord* TleArchive::Find(
+        const unsigned int norad_number,
+        const DateTime& date) const
+{
+    const TleArchiveFile::Index* satellite = Satellite(norad_number);
+
+    if (satellite == NULL)
+    {
+        return NULL;
+    }
+
+    const uint64_t* first = epochs_ + satellite->first;
+    const uint64_t* last = first + satellite->count;
+    const uint64_t* found = std::upper_bound(first, last,
+            static_cast<uint64_t>(date.Ticks()));
+
+    if (found == first)
+    {
+        return NULL;
+    }
+
+    return records_ + (found - epochs_ - 1);
+}
+
+const TleRecord* TleArchive::FindNearest(
+        const unsigned int norad_number,
+        const DateTime& date) const
+{
+    const TleArchiveFile::Index* satellite = Satellite(norad_number);
+
+    if (satellite == NULL)
+    {
+        return NULL;
+    }
+
+    const uint64_t ticks = static_cast<uint64_t>(date.Ticks());
+    const uint64_t* first = epochs_ + satellite->first;
+    const uint64_t* last = first + satellite->count;
+    const uint64_t* found = std::lower_bound(first, last, ticks);
+
+    /*
+     * the nearest is the first epoch at or after date, or the one before
+     */
+    if (found == last
+            || (found != first && ticks - found[-1] <= *found - ticks))
+    {
+        --found;
+    }
+
+    return records_ + (found - epochs_);
+}
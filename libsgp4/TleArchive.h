@@ -0,0 +1,138 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLEARCHIVE_H_
+#define TLEARCHIVE_H_
+
+#include "TleArchiveFile.h"
+#include "TleStream.h"
+#include "TleRecord.h"
+#include "TleException.h"
+#include "DateTime.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief An indexed archive of the element sets of many satellites over
+ * time.
+ *
+ * Build() reads element sets from a stream, sorts them by norad number and
+ * epoch, and writes them to an archive file, keeping only the first of
+ * the element sets read for the same satellite and epoch. The input is
+ * sorted in chunks which are spilled to temporary files and then merged,
+ * so an archive can be built from more element sets than fit in memory.
+ * At most 64 chunks are open at once, so when there are more they are
+ * first merged in groups of 64 into longer chunks, as many times as
+ * needed.
+ *
+ * Opening an archive maps the file into memory. The element sets of a
+ * satellite at a time are then found with two binary searches, one of the
+ * index and one of the epochs of the satellite, without reading the rest
+ * of the archive.
+ */
+class TleArchive
+{
+public:
+    /**
+     * Map an archive and check it.
+     * @param[in] filename the archive to read
+     * @exception TleException if the file cannot be read or is not a
+     * valid archive
+     */
+    TleArchive(const std::string& filename);
+
+    virtual ~TleArchive();
+
+    /**
+     * Build an archive from a stream of element sets. The temporary files
+     * are created next to the archive, and removed once it is written.
+     * @param[in] input the element sets, in any order
+     * @param[in] filename the archive to create
+     * @param[in] chunk the number of element sets sorted in memory at once,
+     * of TleRecord size each
+     * @returns the number of element sets in the archive
+     * @exception TleException if the input cannot be read or a file cannot
+     * be written
+     */
+    static size_t Build(
+            TleStream& input,
+            const std::string& filename,
+            const size_t chunk = 1 << 18);
+
+    /**
+     * @returns the number of element sets
+     */
+    size_t Size() const
+    {
+        return static_cast<size_t>(header_->records);
+    }
+
+    /**
+     * @returns the number of satellites
+     */
+    size_t Satellites() const
+    {
+        return static_cast<size_t>(header_->satellites);
+    }
+
+    /**
+     * @param[in] norad_number the satellite
+     * @param[out] count the number of element sets of the satellite
+     * @returns the element sets of the satellite in order of epoch, or NULL
+     * if it is not in the archive
+     */
+    const TleRecord* History(
+            const unsigned int norad_number,
+            size_t& count) const;
+
+    /**
+     * @param[in] norad_number the satellite
+     * @param[in] date the time
+     * @returns the newest element set with an epoch no later than date, or
+     * NULL if there is none
+     */
+    const TleRecord* Find(
+            const unsigned int norad_number,
+            const DateTime& date) const;
+
+    /**
+     * @param[in] norad_number the satellite
+     * @param[in] date the time
+     * @returns the element set with the epoch nearest to date, the older
+     * of two as near, or NULL if the satellite is not in the archive
+     */
+    const TleRecord* FindNearest(
+            const unsigned int norad_number,
+            const DateTime& date) const;
+
+private:
+    TleArchive(const TleArchive&);
+    TleArchive& operator=(const TleArchive&);
+
+    const TleArchiveFile::Index* Satellite(
+            const unsigned int norad_number) const;
+
+    void* map_;
+    size_t size_;
+    const TleArchiveFile::Header* header_;
+    const TleRecord* records_;
+    const uint64_t* epochs_;
+    const TleArchiveFile::Index* index_;
+};
+
+#endif
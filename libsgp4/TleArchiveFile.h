@@ -0,0 +1,66 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLEARCHIVEFILE_H_
+#define TLEARCHIVEFILE_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Layout of the binary element set archive file.
+ *
+ * The file is a Header, then a TleRecord for every element set sorted by
+ * norad number and epoch, then the epoch of every element set in the same
+ * order, then an Index entry for each satellite sorted by norad number.
+ * The epochs are kept apart from the records so that the search for an
+ * epoch reads only the epochs. Values are stored in the byte order of the
+ * machine that wrote the file.
+ */
+namespace TleArchiveFile
+{
+    const char kMagic[8] = { 'S', 'G', 'P', '4', 'T', 'L', 'A', '\0' };
+    const uint32_t kVersion = 1;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        /** size of a TleRecord in bytes */
+        uint32_t record_size;
+        /** number of element sets */
+        uint64_t records;
+        /** number of satellites */
+        uint64_t satellites;
+        /** offsets from the start of the file */
+        uint64_t records_offset;
+        uint64_t epochs_offset;
+        uint64_t index_offset;
+        uint64_t reserved;
+    };
+
+    struct Index
+    {
+        uint32_t norad_number;
+        uint32_t reserved;
+        /** the first element set of the satellite */
+        uint64_t first;
+        /** the number of element sets of the satellite */
+        uint64_t count;
+    };
+}
+
+#endif
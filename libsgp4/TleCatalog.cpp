@@ -0,0 +1,202 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TleCatalog.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * a line of the catalog, without its line ending
+     */
+    struct Line
+    {
+        const char* text;
+        size_t length;
+    };
+
+    /*
+     * find the line starting at text, and the start of the next one
+     */
+    Line NextLine(const char* text, const char* end, const char*& next)
+    {
+        const char* i = text;
+        while (i != end && *i != '\n')
+        {
+            ++i;
+        }
+        next = i == end ? end : i + 1;
+
+        /*
+         * drop carriage returns and any padding at the end of the line
+         */
+        while (i != text && (i[-1] == '\r' || i[-1] == ' '
+                    || i[-1] == '\t'))
+        {
+            --i;
+        }
+
+        Line line;
+        line.text = text;
+        line.length = static_cast<size_t>(i - text);
+        return line;
+    }
+
+    bool IsElementLine(const Line& line, const char number)
+    {
+        return line.length > 1 && line.text[0] == number
+            && line.text[1] == ' ';
+    }
+}
+
+TleCatalog::TleCatalog(const std::string& filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw TleException("Error opening catalog file");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw TleException("Error reading catalog file size");
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        throw TleException("Error mapping catalog file");
+    }
+
+    /*
+     * the file is read once from start to end
+     */
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    try
+    {
+        Parse(static_cast<const char*>(map), size);
+    }
+    catch (...)
+    {
+        munmap(map, size);
+        throw;
+    }
+
+    munmap(map, size);
+}
+
+TleCatalog::TleCatalog(const char* text, const size_t length)
+{
+    Parse(text, length);
+}
+
+void TleCatalog::Parse(const char* text, const size_t length)
+{
+    const char* end = text + length;
+    const char* next = text;
+    Line name = { NULL, 0 };
+    size_t number = 0;
+
+    /*
+     * a full catalog line is about 70 characters, and three line catalogs
+     * have 3 lines for each element set
+     */
+    records_.reserve(length / (3 * 70));
+
+    while (next != end)
+    {
+        const Line line = NextLine(next, end, next);
+        number++;
+
+        if (line.length == 0)
+        {
+            name.text = NULL;
+            continue;
+        }
+
+        if (!IsElementLine(line, '1'))
+        {
+            /*
+             * a name, with the "0 " of the three line format dropped
+             */
+            name = line;
+            if (name.length > 1 && name.text[0] == '0' && name.text[1] == ' ')
+            {
+                name.text += 2;
+                name.length -= 2;
+            }
+            continue;
+        }
+
+        const char* second = next;
+        const Line line_two = NextLine(second, end, second);
+
+        if (!IsElementLine(line_two, '2'))
+        {
+            /*
+             * a line one on its own
+             */
+            rejected_.push_back(number);
+            name.text = NULL;
+            continue;
+        }
+
+        next = second;
+
+        if (line.length != Tle::LineLength()
+                || line_two.length != Tle::LineLength()
+                || !Tle::IsValidChecksum(line.text)
+                || !Tle::IsValidChecksum(line_two.text))
+        {
+            rejected_.push_back(number);
+        }
+        else
+        {
+            TleRecord record;
+
+            try
+            {
+                Tle::Parse(name.text, name.text ? name.length : 0,
+                        line.text, line_two.text, record);
+                records_.push_back(record);
+            }
+            catch (TleException&)
+            {
+                rejected_.push_back(number);
+            }
+        }
+
+        number++;
+        name.text = NULL;
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLECATALOG_H_
+#define TLECATALOG_H_
+
+#include "Tle.h"
+#include "TleRecord.h"
+#include "TleException.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loads a catalog of two-line element sets from a file in bulk.
+ *
+ * The file is mapped into memory and its lines are found and checked in
+ * place, and each element set is decoded directly from the mapped text
+ * into a TleRecord. The records are held in one contiguous vector, so a
+ * catalog makes no allocation per element set. Both two line and three line
+ * formats are read, and the formats may be mixed: a line which is not
+ * part of an element set is taken as the name of the element set which
+ * follows it, without any leading "0 " and trailing white space.
+ *
+ * Element sets with a wrong length, a wrong checksum or a field which
+ * cannot be decoded are rejected and left out of the catalog, and the
+ * line numbers of their first lines are recorded instead.
+ */
+class TleCatalog
+{
+public:
+    /**
+     * Load a catalog from a file.
+     * @param[in] filename the file to read
+     * @exception TleException if the file cannot be read
+     */
+    TleCatalog(const std::string& filename);
+
+    /**
+     * Load a catalog from text already in memory.
+     * @param[in] text the text of the catalog
+     * @param[in] length the length of the text
+     */
+    TleCatalog(const char* text, const size_t length);
+
+    virtual ~TleCatalog()
+    {
+    }
+
+    /**
+     * @returns the number of element sets loaded
+     */
+    size_t Size() const
+    {
+        return records_.size();
+    }
+
+    /**
+     * @param[in] i the element set, below Size()
+     * @returns the element set, in the order of the file
+     */
+    const TleRecord& operator[](const size_t i) const
+    {
+        return records_[i];
+    }
+
+    /**
+     * @returns every element set loaded, in the order of the file
+     */
+    const std::vector<TleRecord>& Records() const
+    {
+        return records_;
+    }
+
+    /**
+     * @returns the line numbers, counting from one, of the first lines of
+     * the element sets which were rejected
+     */
+    const std::vector<size_t>& Rejected() const
+    {
+        return rejected_;
+    }
+
+private:
+    void Parse(const char* text, const size_t length);
+
+    std::vector<TleRecord> records_;
+    std::vector<size_t> rejected_;
+};
+
+#endif
@@ -0,0 +1,432 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TlePipeline.h"
+
+#include "SGP4.h"
+#include "SatelliteException.h"
+#include "Threads.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <exception>
+
+struct TlePipeline::Batch
+{
+    Batch()
+        : records(kBatchSize),
+        count(0),
+        sequence(0)
+    {
+    }
+
+    std::vector<TleRecord> records;
+    size_t count;
+    size_t sequence;
+    std::string output;
+};
+
+/*
+ * the state shared between the reader, the workers and the writer. a batch
+ * is free, then pending until a worker takes it, then finished until it is
+ * written, when it is free again. a finished batch is held in the slot of
+ * its sequence number, as fewer sequence numbers than slots are in use at
+ * any time
+ */
+struct TlePipeline::Shared
+{
+    Shared(const Handler& h, std::ostream& o, const size_t batches)
+        : handler(h),
+        output(o),
+        finished(batches, static_cast<Batch*>(NULL)),
+        read(0),
+        written(0),
+        records(0),
+        reading(true),
+        stopped(false)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&work, NULL);
+        pthread_cond_init(&done, NULL);
+        pthread_cond_init(&space, NULL);
+    }
+
+    ~Shared()
+    {
+        pthread_cond_destroy(&space);
+        pthread_cond_destroy(&done);
+        pthread_cond_destroy(&work);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    /*
+     * stop every thread early, with the lock held
+     */
+    void Stop()
+    {
+        stopped = true;
+        pthread_cond_broadcast(&work);
+        pthread_cond_broadcast(&done);
+        pthread_cond_broadcast(&space);
+    }
+
+    /*
+     * stop every thread early, keeping the first error
+     */
+    void Fail(const char* message)
+    {
+        Threads::ScopedLock lock(mutex);
+        if (error.empty())
+        {
+            error = message;
+        }
+        Stop();
+    }
+
+    /*
+     * tell the threads that reading has finished and wait for them
+     */
+    void Join()
+    {
+        {
+            Threads::ScopedLock lock(mutex);
+            reading = false;
+            pthread_cond_broadcast(&work);
+            pthread_cond_broadcast(&done);
+        }
+
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        threads.clear();
+    }
+
+    const Handler& handler;
+    std::ostream& output;
+
+    pthread_mutex_t mutex;
+    /** signalled when a batch is pending, or reading stops */
+    pthread_cond_t work;
+    /** signalled when a batch is finished, or reading stops */
+    pthread_cond_t done;
+    /** signalled when a batch is free */
+    pthread_cond_t space;
+
+    std::vector<Batch*> free;
+    std::deque<Batch*> pending;
+    std::vector<Batch*> finished;
+    /** the number of batches read, and of batches written */
+    size_t read;
+    size_t written;
+    /** the number of element sets written */
+    size_t records;
+    bool reading;
+    bool stopped;
+    /** the message of the first exception thrown by the handler */
+    std::string error;
+    /** the threads which were started */
+    std::vector<pthread_t> threads;
+
+private:
+    Shared(const Shared&);
+    Shared& operator=(const Shared&);
+};
+
+TlePipeline::Propagator::Propagator(
+        const double start,
+        const double end,
+        const double step)
+    : start_(start),
+    end_(end),
+    step_(step)
+{
+    if (step_ <= 0.0)
+    {
+        throw SatelliteException("Pipeline step must be positive");
+    }
+}
+
+void TlePipeline::Propagator::Process(
+        const TleRecord& record,
+        std::string& output) const
+{
+    try
+    {
+        const SGP4 model(record);
+        Eci eci(model.Elements().Epoch(), 0.0, 0.0, 0.0);
+        char line[256];
+
+        /*
+         * find each time from the start, so that the steps do not
+         * accumulate rounding errors
+         */
+        const double steps = floor((end_ - start_) / step_);
+        for (double i = 0.0; i <= steps; i += 1.0)
+        {
+            const double tsince = start_ + i * step_;
+
+            if (model.TryFindPosition(tsince, eci) != SGP4::STATUS_OK)
+            {
+                break;
+            }
+
+            const Vector position = eci.Position();
+            const Vector velocity = eci.Velocity();
+            const int length = snprintf(line, sizeof(line),
+                    "%u %17.8f %16.8f %16.8f %16.8f %14.9f %14.9f %14.9f\n",
+                    record.norad_number, tsince,
+                    position.x, position.y, position.z,
+                    velocity.x, velocity.y, velocity.z);
+
+            if (length > 0)
+            {
+                output.append(line, std::min(static_cast<size_t>(length),
+                            sizeof(line) - 1));
+            }
+        }
+    }
+    catch (SatelliteException&)
+    {
+    }
+}
+
+TlePipeline::TlePipeline(
+        const Handler& handler,
+        const unsigned int threads,
+        const size_t batches)
+    : handler_(handler),
+    threads_(threads > 1 ? threads : 1),
+    batches_(batches > 1 ? batches : 1)
+{
+}
+
+void TlePipeline::Process(Shared& shared, Batch& batch)
+{
+    try
+    {
+        for (size_t i = 0; i < batch.count; i++)
+        {
+            shared.handler.Process(batch.records[i], batch.output);
+        }
+    }
+    catch (std::exception& e)
+    {
+        shared.Fail(e.what());
+    }
+    catch (...)
+    {
+        shared.Fail("Unknown error in pipeline handler");
+    }
+}
+
+void* TlePipeline::WorkerThread(void* arg)
+{
+    Shared& shared = *static_cast<Shared*>(arg);
+
+    pthread_mutex_lock(&shared.mutex);
+
+    for (;;)
+    {
+        while (shared.pending.empty() && shared.reading && !shared.stopped)
+        {
+            pthread_cond_wait(&shared.work, &shared.mutex);
+        }
+        if (shared.pending.empty() || shared.stopped)
+        {
+            break;
+        }
+
+        Batch* batch = shared.pending.front();
+        shared.pending.pop_front();
+
+        pthread_mutex_unlock(&shared.mutex);
+        Process(shared, *batch);
+        pthread_mutex_lock(&shared.mutex);
+
+        shared.finished[batch->sequence % shared.finished.size()] = batch;
+        pthread_cond_signal(&shared.done);
+    }
+
+    pthread_mutex_unlock(&shared.mutex);
+
+    return NULL;
+}
+
+void* TlePipeline::WriterThread(void* arg)
+{
+    Shared& shared = *static_cast<Shared*>(arg);
+    const size_t slots = shared.finished.size();
+
+    pthread_mutex_lock(&shared.mutex);
+
+    for (;;)
+    {
+        Batch** slot = &shared.finished[shared.written % slots];
+
+        while (*slot == NULL && !shared.stopped
+                && (shared.reading || shared.written != shared.read))
+        {
+            pthread_cond_wait(&shared.done, &shared.mutex);
+        }
+        if (*slot == NULL || shared.stopped)
+        {
+            break;
+        }
+
+        Batch* batch = *slot;
+        *slot = NULL;
+
+        pthread_mutex_unlock(&shared.mutex);
+        shared.output.write(batch->output.data(),
+                static_cast<std::streamsize>(batch->output.size()));
+        const bool good = shared.output.good();
+        pthread_mutex_lock(&shared.mutex);
+
+        shared.written++;
+        shared.records += batch->count;
+        shared.free.push_back(batch);
+        pthread_cond_signal(&shared.space);
+
+        if (!good)
+        {
+            shared.Stop();
+        }
+    }
+
+    pthread_mutex_unlock(&shared.mutex);
+
+    return NULL;
+}
+
+void TlePipeline::Read(Shared& shared, TleStream& input, const bool parallel)
+{
+    for (;;)
+    {
+        Batch* batch = NULL;
+        {
+            Threads::ScopedLock lock(shared.mutex);
+            while (shared.free.empty() && !shared.stopped)
+            {
+                pthread_cond_wait(&shared.space, &shared.mutex);
+            }
+            if (shared.stopped)
+            {
+                return;
+            }
+            batch = shared.free.back();
+            shared.free.pop_back();
+        }
+
+        batch->count = 0;
+        batch->output.clear();
+        while (batch->count < kBatchSize
+                && input.Next(batch->records[batch->count]))
+        {
+            batch->count++;
+        }
+
+        if (batch->count == 0)
+        {
+            return;
+        }
+
+        if (parallel)
+        {
+            Threads::ScopedLock lock(shared.mutex);
+            batch->sequence = shared.read++;
+            shared.pending.push_back(batch);
+            pthread_cond_signal(&shared.work);
+        }
+        else
+        {
+            Process(shared, *batch);
+            shared.output.write(batch->output.data(),
+                    static_cast<std::streamsize>(batch->output.size()));
+
+            Threads::ScopedLock lock(shared.mutex);
+            shared.records += batch->count;
+            shared.free.push_back(batch);
+            if (!shared.output.good())
+            {
+                shared.Stop();
+            }
+        }
+
+        if (batch->count < kBatchSize)
+        {
+            return;
+        }
+    }
+}
+
+size_t TlePipeline::Run(TleStream& input, std::ostream& output) const
+{
+    Shared shared(handler_, output, batches_);
+    std::vector<Batch> batches(batches_);
+
+    for (size_t i = 0; i < batches.size(); i++)
+    {
+        shared.free.push_back(&batches[i]);
+    }
+
+    pthread_t id;
+    bool parallel = false;
+
+    if (pthread_create(&id, NULL, WriterThread, &shared) == 0)
+    {
+        shared.threads.push_back(id);
+
+        for (size_t i = 0; i < threads_; i++)
+        {
+            if (pthread_create(&id, NULL, WorkerThread, &shared) == 0)
+            {
+                shared.threads.push_back(id);
+                parallel = true;
+            }
+        }
+    }
+
+    /*
+     * this thread reads. if the writer or every worker could not be
+     * started, it also processes and writes each batch itself
+     */
+    try
+    {
+        Read(shared, input, parallel);
+    }
+    catch (...)
+    {
+        {
+            Threads::ScopedLock lock(shared.mutex);
+            shared.Stop();
+        }
+        shared.Join();
+        throw;
+    }
+
+    shared.Join();
+
+    if (!shared.error.empty())
+    {
+        throw SatelliteException(shared.error.c_str());
+    }
+
+    return shared.records;
+}
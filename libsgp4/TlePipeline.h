@@ -0,0 +1,139 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLEPIPELINE_H_
+#define TLEPIPELINE_H_
+
+#include "TleStream.h"
+#include "TleRecord.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Processes a stream of element sets on several threads, writing
+ * the results in the order of the input.
+ *
+ * The calling thread reads element sets from a TleStream into batches,
+ * worker threads pass each element set of a batch to a Handler, and a
+ * writer thread writes the text which the handler produced for each batch
+ * once every batch before it has been written. A fixed number of batches
+ * is allocated up front and reused, so the memory used does not depend on
+ * the length of the input, and reading waits for the writer when every
+ * batch is in use.
+ */
+class TlePipeline
+{
+public:
+    /**
+     * @brief The work done for each element set.
+     *
+     * Process() is called from several threads at once, so it must not
+     * change any state shared between calls.
+     */
+    class Handler
+    {
+    public:
+        virtual ~Handler()
+        {
+        }
+
+        /**
+         * @param[in] record the element set
+         * @param[in,out] output the text to write, to be appended to
+         */
+        virtual void Process(
+                const TleRecord& record,
+                std::string& output) const = 0;
+    };
+
+    /**
+     * @brief A handler which propagates each element set over a span of
+     * time since its epoch.
+     *
+     * Writes a line for each time, holding the norad number, the time
+     * since epoch in minutes, and the position and velocity in km and km/s.
+     * Element sets which fail to initialise are left out, and the output
+     * of an element set stops at the first time which fails to propagate.
+     */
+    class Propagator : public Handler
+    {
+    public:
+        /**
+         * @param[in] start the first time since epoch in minutes
+         * @param[in] end the last time since epoch in minutes
+         * @param[in] step the interval between times in minutes
+         */
+        Propagator(const double start, const double end, const double step);
+
+        virtual void Process(
+                const TleRecord& record,
+                std::string& output) const;
+
+    private:
+        double start_;
+        double end_;
+        double step_;
+    };
+
+    /**
+     * @param[in] handler the work done for each element set
+     * @param[in] threads the number of worker threads
+     * @param[in] batches the number of batches in the pipeline at once
+     */
+    TlePipeline(
+            const Handler& handler,
+            const unsigned int threads = 1,
+            const size_t batches = 64);
+
+    virtual ~TlePipeline()
+    {
+    }
+
+    /**
+     * Process every element set of the input. If the output fails, no more
+     * is read and the state of the output shows the failure.
+     * @param[in] input the element sets
+     * @param[in] output where the results are written
+     * @returns the number of element sets whose results were written
+     * @exception TleException if the input cannot be read
+     * @exception SatelliteException if the handler throws, with its message
+     */
+    size_t Run(TleStream& input, std::ostream& output) const;
+
+private:
+    /*
+     * the number of element sets in a batch
+     */
+    static const size_t kBatchSize = 256;
+
+    struct Batch;
+    struct Shared;
+
+    static void Process(Shared& shared, Batch& batch);
+    static void Read(Shared& shared, TleStream& input, const bool parallel);
+    static void* WorkerThread(void* arg);
+    static void* WriterThread(void* arg);
+
+    const Handler& handler_;
+    unsigned int threads_;
+    size_t batches_;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLERECORD_H_
+#define TLERECORD_H_
+
+#include <cstddef>
+
+/**
+ * @brief A two-line element set in a fixed size record.
+ *
+ * Holds the name and lines inline, and the decoded fields as plain
+ * numbers, so that a record owns no memory of its own and can be copied
+ * with memcpy. A catalog of records is a single allocation, and can be
+ * written to and read from files as it is. Records are made by
+ * Tle::Parse() or Tle::Record(), and both OrbitalElements and SGP4
+ * accept them directly.
+ *
+ * Angles are in degrees and the mean motion is in revolutions per day, as
+ * in the lines.
+ */
+struct TleRecord
+{
+    /** the longest name kept, longer names are cut short */
+    static const size_t kNameLength = 24;
+    static const size_t kLineLength = 69;
+    static const size_t kIntDesignatorLength = 8;
+
+    /** the satellite name, nul terminated */
+    char name[kNameLength + 1];
+    /** tle line one, nul terminated */
+    char line_one[kLineLength + 1];
+    /** tle line two, nul terminated */
+    char line_two[kLineLength + 1];
+    /** the international designator, nul terminated */
+    char int_designator[kIntDesignatorLength + 1];
+    unsigned int norad_number;
+    unsigned int orbit_number;
+    /** the epoch in ticks */
+    unsigned long long epoch;
+    double mean_motion_dt2;
+    double mean_motion_ddt6;
+    double bstar;
+    double inclination;
+    double right_ascending_node;
+    double eccentricity;
+    double argument_perigee;
+    double mean_anomaly;
+    double mean_motion;
+};
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TleStream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+     * the size of the first buffer, which grows if a line is longer
+     */
+    const size_t kBufferSize = 64 * 1024;
+
+    bool IsElementLine(
+            const char* text,
+            const size_t length,
+            const char number)
+    {
+        return length > 1 && text[0] == number && text[1] == ' ';
+    }
+}
+
+TleStream::TleStream(const int fd)
+    : fd_(fd),
+    owned_(false),
+    eof_(false),
+    buffer_(kBufferSize),
+    begin_(0),
+    end_(0),
+    has_name_(false),
+    line_one_length_(0),
+    lines_(0),
+    rejected_(0)
+{
+}
+
+TleStream::TleStream(const std::string& filename)
+    : fd_(open(filename.c_str(), O_RDONLY)),
+    owned_(true),
+    eof_(false),
+    buffer_(kBufferSize),
+    begin_(0),
+    end_(0),
+    has_name_(false),
+    line_one_length_(0),
+    lines_(0),
+    rejected_(0)
+{
+    if (fd_ < 0)
+    {
+        throw TleException("Error opening element set file");
+    }
+}
+
+TleStream::~TleStream()
+{
+    if (owned_)
+    {
+        close(fd_);
+    }
+}
+
+/*
+ * find the next line, without its line ending and any padding at its end.
+ * the text is valid until the next call
+ */
+bool TleStream::NextLine(const char*& text, size_t& length)
+{
+    for (;;)
+    {
+        const char* first = &buffer_[0] + begin_;
+        const char* newline = static_cast<const char*>(
+                memchr(first, '\n', end_ - begin_));
+
+        if (newline != NULL || (eof_ && begin_ != end_))
+        {
+            const char* last = newline != NULL ? newline : &buffer_[0] + end_;
+            begin_ = static_cast<size_t>(last - &buffer_[0]);
+            begin_ += newline != NULL ? 1 : 0;
+
+            while (last != first && (last[-1] == '\r' || last[-1] == ' '
+                        || last[-1] == '\t'))
+            {
+                --last;
+            }
+
+            text = first;
+            length = static_cast<size_t>(last - first);
+            return true;
+        }
+
+        if (eof_)
+        {
+            return false;
+        }
+
+        /*
+         * move the partial line to the front, and make room for more of it
+         */
+        if (begin_ > 0)
+        {
+            memmove(&buffer_[0], first, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (end_ == buffer_.size())
+        {
+            buffer_.resize(2 * buffer_.size());
+        }
+
+        ssize_t count;
+        do
+        {
+            count = read(fd_, &buffer_[end_], buffer_.size() - end_);
+        }
+        while (count < 0 && errno == EINTR);
+
+        if (count < 0)
+        {
+            throw TleException("Error reading element sets");
+        }
+
+        eof_ = count == 0;
+        end_ += static_cast<size_t>(count);
+    }
+}
+
+bool TleStream::Next(TleRecord& record)
+{
+    const char* text;
+    size_t length;
+
+    while (NextLine(text, length))
+    {
+        lines_++;
+
+        if (line_one_length_ != 0)
+        {
+            const size_t line_one_length = line_one_length_;
+            const bool has_name = has_name_;
+            line_one_length_ = 0;
+            has_name_ = false;
+
+            if (IsElementLine(text, length, '2'))
+            {
+                if (line_one_length != Tle::LineLength()
+                        || length != Tle::LineLength()
+                        || !Tle::IsValidChecksum(line_one_)
+                        || !Tle::IsValidChecksum(text))
+                {
+                    rejected_++;
+                    continue;
+                }
+
+                try
+                {
+                    Tle::Parse(has_name ? name_.data() : NULL,
+                            has_name ? name_.length() : 0,
+                            line_one_, text, record);
+                    return true;
+                }
+                catch (TleException&)
+                {
+                    rejected_++;
+                    continue;
+                }
+            }
+
+            /*
+             * a line one on its own, and this line is read afresh
+             */
+            rejected_++;
+        }
+
+        if (length == 0)
+        {
+            has_name_ = false;
+        }
+        else if (IsElementLine(text, length, '1'))
+        {
+            memcpy(line_one_, text, std::min(length, sizeof(line_one_)));
+            line_one_length_ = length;
+        }
+        else
+        {
+            /*
+             * a name, with the "0 " of the three line format dropped
+             */
+            if (length > 1 && text[0] == '0' && text[1] == ' ')
+            {
+                text += 2;
+                length -= 2;
+            }
+            name_.assign(text, length);
+            has_name_ = true;
+        }
+    }
+
+    if (line_one_length_ != 0)
+    {
+        line_one_length_ = 0;
+        rejected_++;
+    }
+
+    return false;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLESTREAM_H_
+#define TLESTREAM_H_
+
+#include "Tle.h"
+#include "TleRecord.h"
+#include "TleException.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads two-line element sets one at a time from a pipe or file.
+ *
+ * The input is read in blocks from a file descriptor, such as standard
+ * input or a FIFO, so an archive of any size can be read in constant
+ * memory, and an input which cannot be mapped or seeked can be read.
+ * Lines are handled as by TleCatalog: the two line and three line formats
+ * may be mixed, and element sets with a wrong length, a wrong checksum or
+ * a field which cannot be decoded are skipped and counted.
+ */
+class TleStream
+{
+public:
+    /**
+     * Read from an open file descriptor, which is not closed.
+     * @param[in] fd the file descriptor
+     */
+    TleStream(const int fd);
+
+    /**
+     * Read from a file or FIFO. Opening a FIFO waits for a writer.
+     * @param[in] filename the file to read
+     * @exception TleException if the file cannot be opened
+     */
+    TleStream(const std::string& filename);
+
+    /**
+     * Closes the file if it was opened by name.
+     */
+    virtual ~TleStream();
+
+    /**
+     * Read the next element set.
+     * @param[out] record the element set
+     * @returns false at the end of the input
+     * @exception TleException if the input cannot be read
+     */
+    bool Next(TleRecord& record);
+
+    /**
+     * @returns the number of lines read
+     */
+    size_t Lines() const
+    {
+        return lines_;
+    }
+
+    /**
+     * @returns the number of element sets which were skipped
+     */
+    size_t Rejected() const
+    {
+        return rejected_;
+    }
+
+private:
+    TleStream(const TleStream&);
+    TleStream& operator=(const TleStream&);
+
+    bool NextLine(const char*& text, size_t& length);
+
+    int fd_;
+    bool owned_;
+    bool eof_;
+    /*
+     * the text read but not yet used is buffer_[begin_, end_)
+     */
+    std::vector<char> buffer_;
+    size_t begin_;
+    size_t end_;
+    /*
+     * the name of the next element set, and its line one while its line
+     * two is read
+     */
+    std::string name_;
+    bool has_name_;
+    char line_one_[TleRecord::kLineLength];
+    size_t line_one_length_;
+    size_t lines_;
+    size_t rejected_;
+};
+
+#endif
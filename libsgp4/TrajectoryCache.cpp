@@ -0,0 +1,203 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TrajectoryCache.h"
+
+#include "SatelliteException.h"
+#include "Threads.h"
+#include "Util.h"
+#include "Vector.h"
+
+void TrajectoryCache::Add(const Tle& tle)
+{
+    const unsigned int norad_number = tle.NoradNumber();
+    const SGP4 model(tle);
+
+    models_.erase(norad_number);
+    models_.insert(std::make_pair(norad_number, model));
+
+    BlockMap::iterator itr = blocks_.begin();
+    while (itr != blocks_.end())
+    {
+        if (itr->first.first.first == norad_number)
+        {
+            blocks_.erase(itr++);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+}
+
+void TrajectoryCache::Fill(
+        const TimeSpan& step,
+        const DateTime& start,
+        const DateTime& end,
+        const unsigned int threads)
+{
+    const long long ticks = step.Ticks();
+
+    if (ticks <= 0)
+    {
+        throw SatelliteException("Grid step must be positive");
+    }
+
+    const long long block_ticks = ticks * kBlockIntervals;
+    const long long first = start.Ticks() / block_ticks;
+    const long long last = end.Ticks() / block_ticks;
+    std::vector<FillTask> tasks;
+
+    /*
+     * create the missing blocks here, so that the threads only write into
+     * blocks they own and never change the map
+     */
+    std::map<unsigned int, SGP4>::const_iterator model;
+    for (model = models_.begin(); model != models_.end(); ++model)
+    {
+        const GridKey grid(model->first, ticks);
+
+        for (long long block = first; block <= last; block++)
+        {
+            const BlockKey key(grid, block);
+
+            if (blocks_.find(key) == blocks_.end())
+            {
+                FillTask task;
+                task.model = &model->second;
+                task.first = block * block_ticks;
+                task.step = ticks;
+                task.block = &blocks_[key];
+                tasks.push_back(task);
+            }
+        }
+    }
+
+    const size_t count = threads > 1 ? threads : 1;
+    std::vector<FillShare> shares(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        shares[i].tasks = &tasks;
+        shares[i].first = i;
+        shares[i].stride = count;
+    }
+
+    Threads::RunShares(FillThread, shares);
+}
+
+void TrajectoryCache::FillBlock(const FillTask& task)
+{
+    Block& block = *task.block;
+
+    task.model->FindPositions(
+            DateTime(static_cast<unsigned long long>(task.first)),
+            TimeSpan(task.step),
+            kBlockSamples,
+            &block.x[0],
+            &block.y[0],
+            &block.z[0],
+            &block.vx[0],
+            &block.vy[0],
+            &block.vz[0],
+            &block.status[0]);
+}
+
+void* TrajectoryCache::FillThread(void* arg)
+{
+    const FillShare& share = *static_cast<const FillShare*>(arg);
+    const std::vector<FillTask>& tasks = *share.tasks;
+
+    for (size_t i = share.first; i < tasks.size(); i += share.stride)
+    {
+        FillBlock(tasks[i]);
+    }
+
+    return NULL;
+}
+
+Eci TrajectoryCache::FindPosition(
+        const unsigned int norad_number,
+        const TimeSpan& step,
+        const DateTime& date)
+{
+    std::map<unsigned int, SGP4>::const_iterator model =
+        models_.find(norad_number);
+
+    if (model == models_.end())
+    {
+        throw SatelliteException("Satellite is not in the cache");
+    }
+
+    const long long ticks = step.Ticks();
+
+    if (ticks <= 0)
+    {
+        throw SatelliteException("Grid step must be positive");
+    }
+
+    const long long sample = date.Ticks() / ticks;
+    const long long block_number = sample / kBlockIntervals;
+    const BlockKey key(GridKey(norad_number, ticks), block_number);
+
+    BlockMap::iterator itr = blocks_.find(key);
+    if (itr == blocks_.end())
+    {
+        FillTask task;
+        task.model = &model->second;
+        task.first = block_number * kBlockIntervals * ticks;
+        task.step = ticks;
+        task.block = &blocks_[key];
+        FillBlock(task);
+        itr = blocks_.find(key);
+    }
+
+    const Block& block = itr->second;
+    const size_t i = static_cast<size_t>(
+            sample - block_number * kBlockIntervals);
+
+    if (block.status[i] != SGP4::STATUS_OK
+            || block.status[i + 1] != SGP4::STATUS_OK)
+    {
+        return model->second.FindPosition(date);
+    }
+
+    const double h = static_cast<double>(ticks) / TicksPerSecond;
+    const double s = static_cast<double>(date.Ticks() - sample * ticks)
+        / static_cast<double>(ticks);
+    Vector position;
+    Vector velocity;
+
+    Util::Hermite(s, h, block.x[i], block.vx[i], block.x[i + 1],
+            block.vx[i + 1], position.x, velocity.x);
+    Util::Hermite(s, h, block.y[i], block.vy[i], block.y[i + 1],
+            block.vy[i + 1], position.y, velocity.y);
+    Util::Hermite(s, h, block.z[i], block.vz[i], block.z[i + 1],
+            block.vz[i + 1], position.z, velocity.z);
+
+    return Eci(date, position, velocity);
+}
+
+size_t TrajectoryCache::Samples() const
+{
+    return blocks_.size() * kBlockSamples;
+}
+
+void TrajectoryCache::Clear()
+{
+    blocks_.clear();
+}
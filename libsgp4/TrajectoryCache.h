@@ -0,0 +1,169 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TRAJECTORYCACHE_H_
+#define TRAJECTORYCACHE_H_
+
+#include "Tle.h"
+#include "SGP4.h"
+#include "Eci.h"
+#include "DateTime.h"
+#include "TimeSpan.h"
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Caches propagated positions on uniform time grids and interpolates
+ * between them.
+ *
+ * For each satellite and grid step the cache holds SGP4 positions and
+ * velocities at whole multiples of the step, in blocks of contiguous arrays
+ * which are propagated the first time they are needed. Positions between
+ * grid points are found by cubic Hermite interpolation of the two
+ * neighbouring samples, which matches SGP4 to better than a metre for
+ * near earth orbits with a one minute step.
+ *
+ * Lookups fill blocks as needed, so a cache must not be shared between
+ * threads without locking. Fill() propagates blocks in parallel.
+ */
+class TrajectoryCache
+{
+public:
+    TrajectoryCache()
+    {
+    }
+
+    virtual ~TrajectoryCache()
+    {
+    }
+
+    /**
+     * Add a satellite, replacing any with the same norad number and
+     * discarding its cached samples.
+     * @param[in] tle the satellite
+     * @exception SatelliteException if the satellite fails to initialise
+     */
+    void Add(const Tle& tle);
+
+    /**
+     * Propagate every sample of every satellite between start and end on
+     * the grid with the given step, which are not already cached.
+     * @param[in] step the grid step
+     * @param[in] start the start of the span
+     * @param[in] end the end of the span
+     * @param[in] threads the number of threads to propagate with
+     * @exception SatelliteException if the step is not positive
+     */
+    void Fill(
+            const TimeSpan& step,
+            const DateTime& start,
+            const DateTime& end,
+            const unsigned int threads = 1);
+
+    /**
+     * Find a position by interpolating the grid with the given step,
+     * propagating the neighbouring samples if they are not cached. If
+     * either sample failed to propagate, the satellite is propagated to
+     * date directly so that the usual exception is thrown.
+     * @param[in] norad_number the satellite
+     * @param[in] step the grid step
+     * @param[in] date the time
+     * @returns the interpolated position and velocity
+     * @exception SatelliteException
+     * @exception DecayedException
+     */
+    Eci FindPosition(
+            const unsigned int norad_number,
+            const TimeSpan& step,
+            const DateTime& date);
+
+    /**
+     * @returns the number of cached samples
+     */
+    size_t Samples() const;
+
+    /**
+     * Discard every cached sample, keeping the satellites.
+     */
+    void Clear();
+
+private:
+    /*
+     * number of grid intervals in a block, each block also holds the
+     * sample at its end so that it can be interpolated on its own
+     */
+    static const long long kBlockIntervals = 256;
+    static const size_t kBlockSamples = kBlockIntervals + 1;
+
+    struct Block
+    {
+        Block()
+            : x(kBlockSamples),
+            y(kBlockSamples),
+            z(kBlockSamples),
+            vx(kBlockSamples),
+            vy(kBlockSamples),
+            vz(kBlockSamples),
+            status(kBlockSamples)
+        {
+        }
+
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> z;
+        std::vector<double> vx;
+        std::vector<double> vy;
+        std::vector<double> vz;
+        std::vector<SGP4::Status> status;
+    };
+
+    /*
+     * a satellite and step, and a block number within that grid
+     */
+    typedef std::pair<unsigned int, long long> GridKey;
+    typedef std::pair<GridKey, long long> BlockKey;
+    typedef std::map<BlockKey, Block> BlockMap;
+
+    struct FillTask
+    {
+        const SGP4* model;
+        long long first;
+        long long step;
+        Block* block;
+    };
+
+    /*
+     * the share of the fill tasks for one thread
+     */
+    struct FillShare
+    {
+        const std::vector<FillTask>* tasks;
+        size_t first;
+        size_t stride;
+    };
+
+    static void FillBlock(const FillTask& task);
+    static void* FillThread(void* arg);
+
+    std::map<unsigned int, SGP4> models_;
+    BlockMap blocks_;
+};
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "Globals.h"
 
+#include <cmath>
 #include <sstream>
 
 namespace Util
@@ -38,12 +39,20 @@ namespace Util
      */
     inline double Mod(const double x, const double y)
     {
+#ifdef SGP4_FAST_MATH
+        /*
+         * select rather than branch, so that loops calling this vectorise
+         */
+        const double m = x - y * floor(x / y);
+        return y == 0 ? x : m;
+#else
         if (y == 0)
         {
             return x;
         }
 
         return x - y * floor(x / y);
+#endif
     }
 
     inline double WrapNegPosPI(const double a)
@@ -53,7 +62,11 @@ namespace Util
     
     inline double WrapTwoPI(const double a)
     {
+#ifdef SGP4_FAST_MATH
+        return a - kTWOPI * floor(a * (1.0 / kTWOPI));
+#else
         return Mod(a, kTWOPI);
+#endif
     }
 
     inline double WrapNegPos180(const double a)
@@ -78,6 +91,13 @@ namespace Util
 
     inline double AcTan(const double sinx, const double cosx)
     {
+#ifdef SGP4_FAST_MATH
+        /*
+         * the same range, -pi/2 to 3pi/2, without branches
+         */
+        const double a = atan2(sinx, cosx);
+        return a <= -kPI / 2.0 ? a + kTWOPI : a;
+#else
         if (cosx == 0.0)
         {
             if (sinx > 0.0)
@@ -100,6 +120,152 @@ namespace Util
                 return kPI + atan(sinx / cosx);
             }
         }
+#endif
+    }
+
+    /*
+     * sine and cosine of x without branches or library calls. x is reduced
+     * to r within pi/4 of a multiple of pi/2, then the taylor series of
+     * sin(r) to r^15 and cos(r) to r^16 are evaluated, which truncate below
+     * 1e-17. in double precision the result is within a few ulp of the
+     * standard library for |x| below about 1e6, beyond which the reduction
+     * loses accuracy.
+     */
+    template <typename T>
+    inline void SinCosPolynomial(const T x, T& sinx, T& cosx)
+    {
+        /*
+         * pi/2 in two parts, the first exact in 33 bits so that k * the
+         * first part is exact
+         */
+        static const double kPIO2_1 = 1.57079632673412561417e+00;
+        static const double kPIO2_1T = 6.07710050650619224932e-11;
+
+        const T k = std::floor(x * T(2.0 / kPI) + T(0.5));
+        const T r = (x - k * T(kPIO2_1)) - k * T(kPIO2_1T);
+        const T r2 = r * r;
+        const int quadrant = static_cast<int>(k) & 3;
+
+        const T s = r + r * r2 * (T(-1.0 / 6.0)
+                + r2 * (T(1.0 / 120.0)
+                + r2 * (T(-1.0 / 5040.0)
+                + r2 * (T(1.0 / 362880.0)
+                + r2 * (T(-1.0 / 39916800.0)
+                + r2 * (T(1.0 / 6227020800.0)
+                + r2 * T(-1.0 / 1307674368000.0)))))));
+        const T c = T(1.0) + r2 * (T(-0.5)
+                + r2 * (T(1.0 / 24.0)
+                + r2 * (T(-1.0 / 720.0)
+                + r2 * (T(1.0 / 40320.0)
+                + r2 * (T(-1.0 / 3628800.0)
+                + r2 * (T(1.0 / 479001600.0)
+                + r2 * (T(-1.0 / 87178291200.0)
+                + r2 * T(1.0 / 20922789888000.0))))))));
+
+        /*
+         * quadrant 0: ( s,  c) 1: ( c, -s) 2: (-s, -c) 3: (-c,  s)
+         */
+        const T swapped_sin = (quadrant & 1) ? c : s;
+        const T swapped_cos = (quadrant & 1) ? s : c;
+        sinx = (quadrant & 2) ? -swapped_sin : swapped_sin;
+        cosx = ((quadrant + 1) & 2) ? -swapped_cos : swapped_cos;
+    }
+
+    /*
+     * sine and cosine of the same angle. uses the standard library, which
+     * the compiler merges into a single sincos call, or SinCosPolynomial()
+     * when built with SGP4_FAST_MATH
+     */
+    template <typename T>
+    inline void SinCos(const T x, T& sinx, T& cosx)
+    {
+#ifdef SGP4_FAST_MATH
+        SinCosPolynomial(x, sinx, cosx);
+#else
+        sinx = std::sin(x);
+        cosx = std::cos(x);
+#endif
+    }
+
+    /*
+     * arc tangent of y / x in (-pi, pi] without branches or library calls.
+     * the ratio of the smaller to the larger of |y| and |x| is reduced to
+     * within 0.66 of zero and the cephes rational approximation is
+     * evaluated, which is within a couple of ulp of the standard library
+     */
+    template <typename T>
+    inline T Atan2Polynomial(const T y, const T x)
+    {
+        const T ax = std::fabs(x);
+        const T ay = std::fabs(y);
+        const T large = ax > ay ? ax : ay;
+        const T small = ax > ay ? ay : ax;
+        const T t = large == T(0.0) ? T(0.0) : small / large;
+
+        /*
+         * atan(t) = pi/4 + atan((t - 1) / (t + 1))
+         */
+        const bool reduce = t > T(0.66);
+        const T u = reduce ? (t - T(1.0)) / (t + T(1.0)) : t;
+        const T offset = reduce ? T(kPI / 4.0) : T(0.0);
+        const T z = u * u;
+        const T p = (((T(-8.750608600031904122785e-1) * z
+                + T(-1.615753718733365076637e1)) * z
+                + T(-7.500855792314704667340e1)) * z
+                + T(-1.228866684490136173410e2)) * z
+                + T(-6.485021904942025371773e1);
+        const T q = ((((z + T(2.485846490142306297962e1)) * z
+                + T(1.650270098316988542046e2)) * z
+                + T(4.328810604912902668951e2)) * z
+                + T(4.853903996359136964868e2)) * z
+                + T(1.945506571482613964425e2);
+        T a = offset + (u * z * p / q + u);
+
+        a = ay > ax ? T(kPI / 2.0) - a : a;
+        a = x < T(0.0) ? T(kPI) - a : a;
+        return y < T(0.0) ? -a : a;
+    }
+
+    /*
+     * arc tangent of y / x. uses the standard library, or Atan2Polynomial()
+     * when built with SGP4_FAST_MATH
+     */
+    template <typename T>
+    inline T Atan2(const T y, const T x)
+    {
+#ifdef SGP4_FAST_MATH
+        return Atan2Polynomial(y, x);
+#else
+        return std::atan2(y, x);
+#endif
+    }
+
+    /*
+     * cubic hermite interpolation of one component between two samples h
+     * seconds apart, with positions p0, p1 and velocities v0, v1 per second,
+     * at s in [0, 1] of the way from the first. gives the position and the
+     * velocity per second
+     */
+    inline void Hermite(
+            const double s,
+            const double h,
+            const double p0,
+            const double v0,
+            const double p1,
+            const double v1,
+            double& p,
+            double& v)
+    {
+        const double s2 = s * s;
+        const double s3 = s2 * s;
+
+        p = (2.0 * s3 - 3.0 * s2 + 1.0) * p0
+            + (s3 - 2.0 * s2 + s) * h * v0
+            + (-2.0 * s3 + 3.0 * s2) * p1
+            + (s3 - s2) * h * v1;
+        v = (6.0 * s2 - 6.0 * s) * (p0 - p1) / h
+            + (3.0 * s2 - 4.0 * s + 1.0) * v0
+            + (3.0 * s2 - 2.0 * s) * v1;
     }
     
     void TrimLeft(std::string& s);